@@ -0,0 +1,130 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "radix_sort.h"
+#include "sort_auto.h"
+#include "mmap_sort.h"
+#include "Measurement and Testing/sorting_test.h"
+
+// counting_sort_u32() must leave arr untouched when it gives up, and every
+// caller must fall through to a radix sort that still sorts the keys.
+
+// arr sorted and a permutation of ref (ref is sorted in the process)
+static int same_sorted(const uint32_t *arr, uint32_t *ref, size_t n) {
+    qsort(ref, n, sizeof(uint32_t), cmp_u32);
+    return memcmp(arr, ref, n * sizeof(uint32_t)) == 0;
+}
+
+// distinct keys spread over the whole 32-bit range, shuffled, each repeated
+static void fill_wide(uint32_t *arr, size_t n, size_t distinct) {
+    for (size_t i = 0; i < n; i++) arr[i] = (uint32_t)(i % distinct) * 16777213u + 7;
+    for (size_t i = n - 1; i > 0; i--) {
+        size_t j = next_key() % (i + 1);
+        uint32_t t = arr[i];
+        arr[i] = arr[j];
+        arr[j] = t;
+    }
+}
+
+// The strided sample sort_auto_plan() reads sees 100 small keys, so it picks
+// counting sort; every other slot holds a wide-range key, 4096 distinct
+static void fill_fooling(uint32_t *arr, size_t n) {
+    size_t stride = n / 1024;
+    for (size_t i = 0; i < n; i++) {
+        arr[i] = i % stride == 0 ? next_key() % 100 : (next_key() % 4096) * 1048573u;
+    }
+}
+
+static int check_counting(size_t n, size_t distinct, int expect) {
+    uint32_t *arr = malloc(n * sizeof(uint32_t));
+    uint32_t *ref = malloc(n * sizeof(uint32_t));
+    fill_wide(arr, n, distinct);
+    memcpy(ref, arr, n * sizeof(uint32_t));
+
+    int ok;
+    if (counting_sort_u32(arr, n, NULL)) {
+        ok = expect && same_sorted(arr, ref, n);
+    } else {
+        ok = !expect && memcmp(arr, ref, n * sizeof(uint32_t)) == 0;
+    }
+    if (!ok) printf("[ERROR] counting_sort_u32: n %zu, %zu distinct keys\n", n, distinct);
+    free(arr);
+    free(ref);
+    return ok;
+}
+
+static int check_sort_auto(size_t n) {
+    uint32_t *arr = malloc(n * sizeof(uint32_t));
+    uint32_t *ref = malloc(n * sizeof(uint32_t));
+    fill_fooling(arr, n);
+    memcpy(ref, arr, n * sizeof(uint32_t));
+
+    int ok = sort_auto_plan(arr, n).alg == SORT_COUNTING;
+    if (!ok) printf("[ERROR] sort_auto_plan: test input no longer picks counting sort\n");
+    sort_plan_t plan = sort_auto(arr, n);
+    if (plan.alg != SORT_RADIX_LSD && plan.alg != SORT_RADIX_MSD) {
+        printf("[ERROR] sort_auto: counting sort did not fall back (ran %s)\n", sort_alg_name(plan.alg));
+        ok = 0;
+    }
+    if (!same_sorted(arr, ref, n)) {
+        printf("[ERROR] sort_auto: counting fallback output not sorted\n");
+        ok = 0;
+    }
+    free(arr);
+    free(ref);
+    return ok;
+}
+
+static int check_msd(size_t n) {
+    uint32_t *arr = malloc(n * sizeof(uint32_t));
+    uint32_t *ref = malloc(n * sizeof(uint32_t));
+    fill_fooling(arr, n);
+    memcpy(ref, arr, n * sizeof(uint32_t));
+    radix_sort_msd_u32(arr, n);
+    int ok = same_sorted(arr, ref, n);
+    if (!ok) printf("[ERROR] radix_sort_msd_u32: n %zu\n", n);
+    free(arr);
+    free(ref);
+    return ok;
+}
+
+static int check_mmap(size_t n) {
+    char path[] = "/tmp/counting_sort_test_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        printf("[ERROR] mkstemp\n");
+        return 0;
+    }
+    uint32_t *arr = malloc(n * sizeof(uint32_t));
+    uint32_t *ref = malloc(n * sizeof(uint32_t));
+    fill_wide(ref, n, 1000);
+    int ok = write(fd, ref, n * sizeof(uint32_t)) == (ssize_t)(n * sizeof(uint32_t));
+
+    mmap_sort_stats_t st;
+    ok = ok && mmap_sort_u32(path, SORT_COUNTING, &st);
+    ok = ok && st.alg == SORT_RADIX_LSD;
+    ok = ok && pread(fd, arr, n * sizeof(uint32_t), 0) == (ssize_t)(n * sizeof(uint32_t));
+    ok = ok && same_sorted(arr, ref, n);
+    if (!ok) printf("[ERROR] mmap_sort_u32: counting fallback\n");
+    close(fd);
+    unlink(path);
+    free(arr);
+    free(ref);
+    return ok;
+}
+
+int main(void) {
+    int ok = 1;
+    ok &= check_counting(100000, 256, 1);     // the most the hash table keeps
+    ok &= check_counting(100000, 257, 0);
+    ok &= check_counting(100000, 5000, 0);
+    ok &= check_counting(300, 300, 0);
+    ok &= check_sort_auto(1 << 16);
+    ok &= check_sort_auto(1 << 20);
+    ok &= check_msd(1 << 18);
+    ok &= check_mmap(1 << 18);
+    if (!ok) return 1;
+    printf("[OK] Counting sort fallback passed\n");
+    return 0;
+}
@@ -0,0 +1,110 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "timsort.h"
+#include "radix_sort.h"
+#include "Measurement and Testing/sorting_test.h"
+
+// timsort_f32/_f64 and radix_sort_f32/_f64 must put NaNs, signed zeros and
+// infinities in the same place: IEEE 754 totalOrder,
+// -NaN < -inf < ... < -0.0 < +0.0 < ... < +inf < +NaN.
+
+static float f32_bits(uint32_t b) {
+    float x;
+    memcpy(&x, &b, sizeof(x));
+    return x;
+}
+
+static double f64_bits(uint64_t b) {
+    double x;
+    memcpy(&x, &b, sizeof(x));
+    return x;
+}
+
+// 0: -NaN, 1: -inf, 2: negative numbers, 3: -0.0, 4: +0.0 and positive numbers,
+// 5: +inf, 6: +NaN
+static int rank_f64(double x) {
+    if (isnan(x)) return signbit(x) ? 0 : 6;
+    if (isinf(x)) return x < 0 ? 1 : 5;
+    if (x == 0) return signbit(x) ? 3 : 4;
+    return x < 0 ? 2 : 4;
+}
+
+// Keys ascend by rank, and by value inside the finite ranks
+static int ordered(const double *a, size_t n) {
+    for (size_t i = 1; i < n; i++) {
+        int r = rank_f64(a[i - 1]), s = rank_f64(a[i]);
+        if (r > s || (r == s && r != 0 && r != 6 && a[i - 1] > a[i])) return 0;
+    }
+    return 1;
+}
+
+// Specials (NaNs with both signs and several payloads, zeros, infinities,
+// subnormals, extremes) mixed with random numbers of both signs
+static void fill_f64(double *a, size_t n) {
+    static const uint64_t specials[] = {
+        0x7ff8000000000000ull, 0xfff8000000000000ull, 0x7ff0000000000001ull, 0xfff0000000000001ull,
+        0x7fffffffffffffffull, 0xffffffffffffffffull, 0x0000000000000000ull, 0x8000000000000000ull,
+        0x7ff0000000000000ull, 0xfff0000000000000ull, 0x0000000000000001ull, 0x8000000000000001ull,
+        0x7fefffffffffffffull, 0xffefffffffffffffull, 0x3ff0000000000000ull, 0xbff0000000000000ull,
+    };
+    size_t ns = sizeof(specials) / sizeof(specials[0]);
+    for (size_t i = 0; i < n; i++) {
+        a[i] = next_key() % 3 == 0 ? f64_bits(specials[next_key() % ns])
+                                   : (double)(int64_t)(next_key() % 2001) - 1000.0;
+    }
+}
+
+static int check_f64(size_t n) {
+    double *a = malloc(n * sizeof(double)), *b = malloc(n * sizeof(double));
+    double *temp = malloc(n * sizeof(double));
+    fill_f64(a, n);
+    memcpy(b, a, n * sizeof(double));
+    timsort_f64(a, n);
+    radix_sort_f64(b, n, temp);
+    int ok = ordered(a, n) && memcmp(a, b, n * sizeof(double)) == 0;
+    if (!ok) printf("[ERROR] timsort_f64 / radix_sort_f64 disagree: n %zu\n", n);
+    free(a);
+    free(b);
+    free(temp);
+    return ok;
+}
+
+static int check_f32(size_t n) {
+    static const uint32_t specials[] = {
+        0x7fc00000u, 0xffc00000u, 0x7f800001u, 0xff800001u, 0x00000000u, 0x80000000u,
+        0x7f800000u, 0xff800000u, 0x00000001u, 0x80000001u, 0x7f7fffffu, 0xff7fffffu,
+    };
+    size_t ns = sizeof(specials) / sizeof(specials[0]);
+    float *a = malloc(n * sizeof(float)), *b = malloc(n * sizeof(float));
+    float *temp = malloc(n * sizeof(float));
+    double *wide = malloc(n * sizeof(double));
+    for (size_t i = 0; i < n; i++) {
+        a[i] = next_key() % 3 == 0 ? f32_bits(specials[next_key() % ns])
+                                   : (float)(int32_t)(next_key() % 2001) - 1000.0f;
+    }
+    memcpy(b, a, n * sizeof(float));
+    timsort_f32(a, n);
+    radix_sort_f32(b, n, temp);
+    for (size_t i = 0; i < n; i++) wide[i] = a[i];     // keeps NaN signs and zero signs
+    int ok = ordered(wide, n) && memcmp(a, b, n * sizeof(float)) == 0;
+    if (!ok) printf("[ERROR] timsort_f32 / radix_sort_f32 disagree: n %zu\n", n);
+    free(a);
+    free(b);
+    free(temp);
+    free(wide);
+    return ok;
+}
+
+int main(void) {
+    int ok = 1;
+    static const size_t sizes[] = {2, 17, 64, 1000, 100000};   // insertion sort and merges
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        ok &= check_f64(sizes[s]);
+        ok &= check_f32(sizes[s]);
+    }
+    if (!ok) return 1;
+    printf("[OK] Float order passed\n");
+    return 0;
+}
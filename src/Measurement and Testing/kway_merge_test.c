@@ -0,0 +1,173 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "kway_merge.h"
+#include "Measurement and Testing/sorting_test.h"
+
+// k-way merge against qsort() of the concatenated runs: the packed uint32 path
+// with UINT32_MAX keys, empty runs, k past 256, exact split partitions, and the
+// parallel merge at several task counts.
+
+// k sorted runs, every fourth one empty. Keys come from [0, range) with about
+// 1 in 16 replaced by the largest key (UINT32_MAX / UINT64_MAX after the cast).
+typedef struct {
+    size_t k, total;
+    size_t *lens;
+    uint32_t **r32;
+    uint64_t **r64;
+    uint32_t *ref32;        // every key, sorted
+    uint64_t *ref64;
+} runs_t;
+
+static void make_runs(runs_t *r, size_t k, size_t max_len, uint64_t range) {
+    r->k = k;
+    r->total = 0;
+    r->lens = calloc(k + 1, sizeof(size_t));
+    r->r32 = calloc(k + 1, sizeof(uint32_t *));
+    r->r64 = calloc(k + 1, sizeof(uint64_t *));
+    for (size_t i = 0; i < k; i++) {
+        r->lens[i] = i % 4 == 3 ? 0 : next_key() % (max_len + 1);
+        r->total += r->lens[i];
+    }
+    r->ref32 = malloc((r->total + 1) * sizeof(uint32_t));
+    r->ref64 = malloc((r->total + 1) * sizeof(uint64_t));
+    size_t o = 0;
+    for (size_t i = 0; i < k; i++) {
+        size_t n = r->lens[i];
+        r->r32[i] = malloc((n + 1) * sizeof(uint32_t));
+        r->r64[i] = malloc((n + 1) * sizeof(uint64_t));
+        for (size_t j = 0; j < n; j++) {
+            uint64_t x = next_key() % 16 == 0 ? UINT64_MAX : next_key() % range;
+            r->r64[i][j] = x;
+            r->r32[i][j] = x == UINT64_MAX ? UINT32_MAX : (uint32_t)x;
+        }
+        qsort(r->r32[i], n, sizeof(uint32_t), cmp_u32);
+        qsort(r->r64[i], n, sizeof(uint64_t), cmp_u64);
+        memcpy(r->ref32 + o, r->r32[i], n * sizeof(uint32_t));
+        memcpy(r->ref64 + o, r->r64[i], n * sizeof(uint64_t));
+        o += n;
+    }
+    qsort(r->ref32, r->total, sizeof(uint32_t), cmp_u32);
+    qsort(r->ref64, r->total, sizeof(uint64_t), cmp_u64);
+}
+
+static void free_runs(runs_t *r) {
+    for (size_t i = 0; i < r->k; i++) {
+        free(r->r32[i]);
+        free(r->r64[i]);
+    }
+    free(r->lens);
+    free(r->r32);
+    free(r->r64);
+    free(r->ref32);
+    free(r->ref64);
+}
+
+static int check_merge(runs_t *r, size_t threads) {
+    uint32_t *o32 = malloc((r->total + 1) * sizeof(uint32_t));
+    uint64_t *o64 = malloc((r->total + 1) * sizeof(uint64_t));
+    const uint32_t *const *r32 = (const uint32_t *const *)r->r32;
+    const uint64_t *const *r64 = (const uint64_t *const *)r->r64;
+    int ok = threads == 1 ? kway_merge_u32(r32, r->lens, r->k, o32) &&
+                            kway_merge_u64(r64, r->lens, r->k, o64)
+                          : kway_merge_parallel_u32(r32, r->lens, r->k, o32, threads) &&
+                            kway_merge_parallel_u64(r64, r->lens, r->k, o64, threads);
+    ok = ok && memcmp(o32, r->ref32, r->total * sizeof(uint32_t)) == 0;
+    ok = ok && memcmp(o64, r->ref64, r->total * sizeof(uint64_t)) == 0;
+    if (!ok) printf("[ERROR] kway_merge: k %zu, %zu keys, %zu threads\n", r->k, r->total, threads);
+    free(o32);
+    free(o64);
+    return ok;
+}
+
+// Splits at ranks 0 < a < b < total: the cut positions sum to the rank, never
+// move backwards, and merging the slice between two cuts yields ref[a..b)
+static int check_split(runs_t *r) {
+    size_t k = r->k, t = r->total;
+    size_t ranks[5] = {0, t / 3, t / 2, t ? t - 1 : 0, t};
+    size_t *pos = calloc(5 * (k + 1), sizeof(size_t));
+    const uint32_t **cur = calloc(k + 1, sizeof(uint32_t *));
+    size_t *len = calloc(k + 1, sizeof(size_t));
+    uint32_t *out = malloc((r->total + 1) * sizeof(uint32_t));
+    const uint32_t *const *r32 = (const uint32_t *const *)r->r32;
+    int ok = 1;
+    for (size_t s = 0; s < 5; s++) {
+        size_t *p = pos + s * (k + 1), sum = 0;
+        kway_split_u32(r32, r->lens, k, ranks[s], p);
+        for (size_t i = 0; i < k; i++) {
+            sum += p[i];
+            if (p[i] > r->lens[i] || (s > 0 && p[i] < p[i - (k + 1)])) ok = 0;
+        }
+        if (sum != ranks[s]) ok = 0;
+        if (!ok || s == 0) continue;
+
+        size_t *q = p - (k + 1);
+        for (size_t i = 0; i < k; i++) {
+            cur[i] = r->r32[i] + q[i];
+            len[i] = p[i] - q[i];
+        }
+        ok = kway_merge_u32(cur, len, k, out) &&
+             memcmp(out, r->ref32 + ranks[s - 1], (ranks[s] - ranks[s - 1]) * sizeof(uint32_t)) == 0;
+    }
+    if (!ok) printf("[ERROR] kway_split_u32: k %zu, %zu keys\n", k, r->total);
+    free(pos);
+    free(cur);
+    free(len);
+    free(out);
+    return ok;
+}
+
+// The tree as a stream merger: keys come out in order, ties by input index
+static int check_tree(runs_t *r) {
+    kway_tree_t t;
+    if (!kway_tree_init(&t, r->k)) return 0;
+    size_t *p = calloc(r->k + 1, sizeof(size_t));
+    for (size_t i = 0; i < r->k; i++) {
+        if (r->lens[i]) kway_tree_set(&t, i, r->r64[i][0]);
+    }
+    kway_tree_build(&t);
+    size_t n = 0, last = 0;
+    int ok = 1;
+    for (size_t w; ok && (w = kway_tree_top(&t)) < r->k; n++) {
+        uint64_t key = kway_tree_top_key(&t);
+        ok = key == r->ref64[n] && !(n > 0 && key == r->ref64[n - 1] && w < last);
+        last = w;
+        if (++p[w] < r->lens[w]) {
+            kway_tree_next(&t, r->r64[w][p[w]]);
+        } else {
+            kway_tree_drop(&t);
+        }
+    }
+    ok = ok && n == r->total;
+    if (!ok) printf("[ERROR] kway_tree: k %zu, %zu keys\n", r->k, r->total);
+    kway_tree_free(&t);
+    free(p);
+    return ok;
+}
+
+int main(void) {
+    static const size_t ks[] = {0, 1, 2, 3, 255, 256, 257, 1000};
+    static const uint64_t ranges[] = {4, 1000000, UINT64_MAX};
+    int ok = 1;
+    for (size_t a = 0; a < sizeof(ks) / sizeof(ks[0]); a++) {
+        for (size_t b = 0; b < sizeof(ranges) / sizeof(ranges[0]); b++) {
+            runs_t r;
+            make_runs(&r, ks[a], 4000, ranges[b]);
+            ok &= check_merge(&r, 1);
+            ok &= check_split(&r);
+            ok &= check_tree(&r);
+            free_runs(&r);
+        }
+    }
+    // Large enough for several merge tasks (the pool may have a single worker)
+    static const size_t threads[] = {0, 2, 3, 8};
+    for (size_t a = 0; a < sizeof(threads) / sizeof(threads[0]); a++) {
+        runs_t r;
+        make_runs(&r, 37 + 300 * a, 1200000 / (37 + 300 * a), a == 1 ? 50 : UINT64_MAX);
+        ok &= check_merge(&r, threads[a]);
+        free_runs(&r);
+    }
+    if (!ok) return 1;
+    printf("[OK] K-way merge passed\n");
+    return 0;
+}
@@ -0,0 +1,184 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include "timsort.h"
+#include "parallel_sort.h"
+#include "sort_auto.h"
+#include "sort_alloc.h"
+#include "thread_pool.h"
+#include "Measurement and Testing/sorting_test.h"
+
+// Every uint32 entry point against qsort(): timsort() in each merge mode, a
+// reused workspace, caller-owned scratch of several sizes, sort_array() with and without scratch, sort_parallel() on the
+// pool and sort_auto(). Sizes straddle minrun, the 256-element in-place buffer
+// and PAR_MIN_CHUNK (64K); sort_parallel() gets 4 tasks even on a 1-CPU host.
+
+#define NDIST 7
+
+// 0: random, 1: sorted, 2: descending, 3: five distinct keys, 4: organ pipe,
+// 5: all equal, 6: sorted with 1 in 64 keys replaced
+static void fill(T *arr, size_t n, int dist) {
+    for (size_t i = 0; i < n; i++) {
+        switch (dist) {
+            case 0: arr[i] = (T)next_key(); break;
+            case 1: arr[i] = (T)i; break;
+            case 2: arr[i] = (T)(n - i); break;
+            case 3: arr[i] = (T)(next_key() % 5); break;
+            case 4: arr[i] = (T)(i < n / 2 ? i : n - i); break;
+            case 5: arr[i] = 7; break;
+            default: arr[i] = next_key() % 64 == 0 ? (T)next_key() : (T)i; break;
+        }
+    }
+}
+
+typedef struct {
+    const char *name;
+    void (*sort)(T *arr, size_t n);
+} entry_t;
+
+static void run_pingpong(T *arr, size_t n) { timsort_mode(arr, n, TIMSORT_PINGPONG); }
+static void run_half(T *arr, size_t n)     { timsort_mode(arr, n, TIMSORT_HALF_BUFFER); }
+static void run_inplace(T *arr, size_t n)  { timsort_mode(arr, n, TIMSORT_INPLACE); }
+static void run_parallel(T *arr, size_t n) { sort_parallel(arr, n, 4); }
+static void run_auto(T *arr, size_t n)     { sort_auto(arr, n); }
+
+// One workspace per mode for the whole test: starts small, grows on demand
+static timsort_ws_t ws_pingpong, ws_half, ws_inplace;
+static void run_ws_pingpong(T *arr, size_t n) { timsort_with_ws(&ws_pingpong, arr, n); }
+static void run_ws_half(T *arr, size_t n)     { timsort_with_ws(&ws_half, arr, n); }
+static void run_ws_inplace(T *arr, size_t n)  { timsort_with_ws(&ws_inplace, arr, n); }
+
+// Caller-owned scratch: a full, a half and a too-small buffer (freeing or growing
+// it would fault, since it is not sort_buf_alloc() memory)
+static T buf[262144 + 1000];
+static void run_buf_pingpong(T *arr, size_t n) { timsort_with_buf(arr, n, buf, n, TIMSORT_PINGPONG); }
+static void run_buf_half(T *arr, size_t n)     { timsort_with_buf(arr, n, buf, n / 2 + 1, TIMSORT_HALF_BUFFER); }
+static void run_buf_small(T *arr, size_t n)    { timsort_with_buf(arr, n, buf, 300, TIMSORT_HALF_BUFFER); }
+static void run_buf_short(T *arr, size_t n)    { timsort_with_buf(arr, n, buf, n / 2, TIMSORT_PINGPONG); }
+
+static const entry_t entries[] = {
+    {"timsort",              timsort},
+    {"timsort_pingpong",     run_pingpong},
+    {"timsort_half_buffer",  run_half},
+    {"timsort_inplace",      run_inplace},
+    {"timsort_ws_pingpong",  run_ws_pingpong},
+    {"timsort_ws_half",      run_ws_half},
+    {"timsort_ws_inplace",   run_ws_inplace},
+    {"timsort_buf_pingpong", run_buf_pingpong},
+    {"timsort_buf_half",     run_buf_half},
+    {"timsort_buf_small",    run_buf_small},
+    {"timsort_buf_short",    run_buf_short},
+    {"sort_array",           sort_array},
+    {"sort_parallel_t4",     run_parallel},
+    {"sort_auto",            run_auto},
+};
+
+static int check(const entry_t *e, size_t n, int dist) {
+    T *arr = malloc((n + 1) * sizeof(T));
+    T *ref = malloc((n + 1) * sizeof(T));
+    fill(arr, n, dist);
+    memcpy(ref, arr, n * sizeof(T));
+    qsort(ref, n, sizeof(T), cmp_u32);
+    e->sort(arr, n);
+    int ok = memcmp(arr, ref, n * sizeof(T)) == 0;
+    if (!ok) printf("[ERROR] %s: n %zu, distribution %d\n", e->name, n, dist);
+    free(arr);
+    free(ref);
+    return ok;
+}
+
+// sort_array() without scratch: cap the address space just above what is mapped,
+// so its n-element buffer cannot be allocated and it takes the in-place merge
+static int check_sort_array_no_scratch(size_t n) {
+#if defined(__linux__) && !defined(__SANITIZE_ADDRESS__)
+    T *arr = malloc(n * sizeof(T));
+    T *ref = malloc(n * sizeof(T));
+    fill(arr, n, 0);
+    memcpy(ref, arr, n * sizeof(T));
+    qsort(ref, n, sizeof(T), cmp_u32);
+
+    unsigned long pages = 0;
+    FILE *f = fopen("/proc/self/statm", "r");
+    int ok = f && fscanf(f, "%lu", &pages) == 1;
+    if (f) fclose(f);
+    struct rlimit old;
+    ok = ok && getrlimit(RLIMIT_AS, &old) == 0;
+    if (!ok) {
+        printf("[ERROR] sort_array: cannot read the address-space limit\n");
+    } else {
+        struct rlimit cap = old;
+        cap.rlim_cur = pages * 4096 + n * sizeof(T) / 2;
+        if (old.rlim_cur == RLIM_INFINITY || cap.rlim_cur < old.rlim_cur) {
+            setrlimit(RLIMIT_AS, &cap);
+        }
+        sort_array(arr, n);
+        setrlimit(RLIMIT_AS, &old);
+        ok = memcmp(arr, ref, n * sizeof(T)) == 0;
+        if (!ok) printf("[ERROR] sort_array: in-place fallback, n %zu\n", n);
+    }
+    free(arr);
+    free(ref);
+    return ok;
+#else
+    (void)n;
+    return 1;
+#endif
+}
+
+// sort_auto_plan() on inputs built to take each branch
+static int check_plan(void) {
+    size_t n = (size_t)1 << 22;
+    T *arr = malloc(n * sizeof(T));
+    int ok = 1;
+
+    fill(arr, 1 << 16, 1);
+    ok &= sort_auto_plan(arr, 1 << 16).alg == SORT_TIMSORT;
+    fill(arr, 1 << 16, 3);
+    ok &= sort_auto_plan(arr, 1 << 16).alg == SORT_COUNTING;
+    fill(arr, 1 << 20, 0);
+    ok &= sort_auto_plan(arr, 1 << 20).alg == SORT_RADIX_LSD;
+
+    // Large random input: the samplesort whenever the pool has several workers
+    fill(arr, n, 0);
+    tpool_t *pool = tpool_default();
+    bool cores = pool && tpool_size(pool) > 1;
+    ok &= sort_auto_plan(arr, n).alg == (cores ? SORT_PARALLEL : SORT_RADIX_LSD);
+
+    // One key in a third of the slots would fill one samplesort bucket
+    for (size_t i = 0; i < n; i += 3) arr[i] = 12345;
+    ok &= sort_auto_plan(arr, n).alg == SORT_RADIX_MSD;
+
+    if (!ok) printf("[ERROR] sort_auto_plan: unexpected algorithm choice\n");
+    free(arr);
+    return ok;
+}
+
+int main(void) {
+    static const size_t sizes[] = {
+        0, 1, 2, 31, 32, 33, 63, 64, 65, 127, 128, 129,         // around minrun
+        255, 256, 257, 511, 512, 513, 1000, 4097, 20000,        // in-place buffer
+        65535, 65536, 131071, 131072, 131073, 262144 + 1000,    // PAR_MIN_CHUNK
+    };
+    timsort_ws_init(&ws_pingpong, 16, TIMSORT_PINGPONG, false);
+    timsort_ws_init(&ws_half, 16, TIMSORT_HALF_BUFFER, false);
+    timsort_ws_init(&ws_inplace, 16, TIMSORT_INPLACE, false);
+
+    int ok = 1;
+    for (size_t e = 0; e < sizeof(entries) / sizeof(entries[0]); e++) {
+        for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+            for (int d = 0; d < NDIST; d++) {
+                ok &= check(&entries[e], sizes[s], d);
+            }
+        }
+    }
+    ok &= check_sort_array_no_scratch(1 << 20);
+    ok &= check_plan();
+
+    timsort_ws_free(&ws_pingpong);
+    timsort_ws_free(&ws_half);
+    timsort_ws_free(&ws_inplace);
+    if (!ok) return 1;
+    printf("[OK] Sort entry points passed\n");
+    return 0;
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <stddef.h>
+#include <stdint.h>
 #include "timsort.h"
 #include "metrics.h"
 
@@ -14,3 +15,23 @@ typedef enum {
 void generate_data(T *arr, size_t n, data_dist_t dist);
 int is_sorted(T *arr, size_t n);
 void sort_array(T *arr, size_t size);
+
+/* Deterministic xorshift64 keys, the same sequence in every test run */
+static inline uint64_t next_key(void) {
+    static uint64_t rng = 88172645463325252ULL;
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    return rng;
+}
+
+/* qsort() comparators for the reference sorts */
+static inline int cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static inline int cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
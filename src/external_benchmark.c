@@ -0,0 +1,166 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "external_sort.h"
+
+// ============================================================================
+// Out-of-core sort benchmark: end-to-end GB/s of external_sort_u32/_u64 next to
+// the raw sequential read and write bandwidth of the same directory.
+//
+//   ./bench_external [elements] [mem_MB] [dir] [key_bytes]
+//
+// Defaults: 256M elements, 256 MB budget, current directory, 4-byte keys. Keep
+// elements * key_bytes well above mem_MB (and ideally above RAM) so the page
+// cache cannot hold the data; every file is also dropped from the cache
+// (fsync + POSIX_FADV_DONTNEED where available) before it is read.
+// ============================================================================
+
+#define IO_BUF ((size_t)8 << 20)
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void die(const char *what) {
+    fprintf(stderr, "%s: %s\n", what, strerror(errno));
+    exit(1);
+}
+
+// Flush a file to disk and evict it from the page cache
+static void drop_cache(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) die(path);
+    fsync(fd);
+#ifdef POSIX_FADV_DONTNEED
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+#endif
+    close(fd);
+}
+
+// Write random keys to path; returns seconds including fsync
+static double write_input(const char *path, size_t n, size_t width) {
+    char *buf = (char *)malloc(IO_BUF);
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (!buf || fd < 0) die(path);
+
+    uint64_t s = 88172645463325252ULL;
+    size_t per = IO_BUF / width;
+    double t0 = now_sec();
+    for (size_t done = 0; done < n; ) {
+        size_t m = n - done < per ? n - done : per;
+        for (size_t i = 0; i < m; i++) {
+            s ^= s << 13;
+            s ^= s >> 7;
+            s ^= s << 17;
+            memcpy(buf + i * width, &s, width);     // low bytes on little-endian hosts
+        }
+        if (write(fd, buf, m * width) != (ssize_t)(m * width)) die(path);
+        done += m;
+    }
+    fsync(fd);
+    double t = now_sec() - t0;
+    close(fd);
+    free(buf);
+    return t;
+}
+
+// Read path sequentially; returns seconds. With check, also verifies the keys
+// ascend and that there are n of them.
+static double read_file(const char *path, size_t n, size_t width, int check) {
+    char *buf = (char *)malloc(IO_BUF);
+    int fd = open(path, O_RDONLY);
+    if (!buf || fd < 0) die(path);
+
+    uint64_t prev = 0;
+    size_t count = 0;
+    ssize_t r;
+    double t0 = now_sec();
+    while ((r = read(fd, buf, IO_BUF)) > 0) {
+        for (ssize_t i = 0; check && i + (ssize_t)width <= r; i += (ssize_t)width) {
+            uint64_t x = 0;
+            memcpy(&x, buf + i, width);
+            if (x < prev) {
+                fprintf(stderr, "VERIFICATION FAILED at key %zu\n", count);
+                exit(1);
+            }
+            prev = x;
+            count++;
+        }
+    }
+    if (r < 0) die(path);
+    double t = now_sec() - t0;
+    if (check && count != n) {
+        fprintf(stderr, "VERIFICATION FAILED: %zu keys, expected %zu\n", count, n);
+        exit(1);
+    }
+    close(fd);
+    free(buf);
+    return t;
+}
+
+int main(int argc, char *argv[]) {
+    size_t n = (size_t)256 << 20;
+    size_t mem_mb = 256;
+    const char *dir = ".";
+    size_t width = 4;
+
+    if (argc > 1) n = (size_t)atoll(argv[1]);
+    if (argc > 2) mem_mb = (size_t)atoll(argv[2]);
+    if (argc > 3) dir = argv[3];
+    if (argc > 4) width = (size_t)atoll(argv[4]);
+    if (width != 4 && width != 8) {
+        fprintf(stderr, "key_bytes must be 4 or 8\n");
+        return 1;
+    }
+
+    char in_path[4096], out_path[4096];
+    snprintf(in_path, sizeof(in_path), "%s/ext_in.bin", dir);
+    snprintf(out_path, sizeof(out_path), "%s/ext_out.bin", dir);
+    double gb = (double)n * width / (1024.0 * 1024.0 * 1024.0);
+
+    printf("=== External Sort Benchmark ===\n");
+    printf("Keys: %zu x %zu bytes (%.3f GB), budget %zu MB, dir %s\n\n", n, width, gb, mem_mb, dir);
+
+    // Raw disk bandwidth: write the input, then read it back cold
+    double write_sec = write_input(in_path, n, width);
+    drop_cache(in_path);
+    double read_sec = read_file(in_path, n, width, 0);
+    drop_cache(in_path);
+    double disk_read = gb / read_sec, disk_write = gb / write_sec;
+    double disk_copy = gb / (read_sec + write_sec);    // one read + one write of the data
+
+    printf("mode,size_GB,mem_MB,runs,merge_passes,run_sec,merge_sec,total_sec,");
+    printf("GB_s,disk_read_GB_s,disk_write_GB_s,disk_copy_GB_s,vs_copy\n");
+
+    const char *modes[] = {"sync", "async"};
+    for (int async = 0; async <= 1; async++) {
+        ext_sort_opts_t opts = {mem_mb << 20, 0, dir, async};
+        ext_sort_stats_t st;
+
+        double t0 = now_sec();
+        bool ok = width == 4 ? external_sort_u32(in_path, out_path, &opts, &st)
+                             : external_sort_u64(in_path, out_path, &opts, &st);
+        if (!ok) die("external_sort");
+        drop_cache(out_path);       // includes the fsync: the sort is durable
+        double total = now_sec() - t0;
+
+        read_file(out_path, n, width, 1);
+        drop_cache(in_path);
+
+        printf("%s,%.3f,%zu,%zu,%zu,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.2f\n",
+            modes[async], gb, mem_mb, st.runs, st.merge_passes,
+            st.run_sec, st.merge_sec, total,
+            gb / total, disk_read, disk_write, disk_copy, gb / total / disk_copy);
+    }
+
+    unlink(in_path);
+    unlink(out_path);
+    printf("\n=== Benchmark Complete ===\n");
+    return 0;
+}
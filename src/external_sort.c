@@ -0,0 +1,447 @@
+#include "external_sort.h"
+#include "kway_merge.h"
+#include "timsort.h"
+#include "thread_pool.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define EXT_MEM    ((size_t)256 << 20)  // default memory budget
+#define EXT_IO     ((size_t)8 << 20)    // default largest buffer per merge stream
+#define EXT_MIN_IO ((size_t)256 << 10)  // smaller merge buffers mean more seeks: add a pass instead
+#define EXT_ALIGN  4096                 // buffer sizes are multiples of this (and of every key width)
+
+typedef struct {
+    off_t off;
+    off_t len;
+} ext_run_t;
+
+// Sorts n keys in place; ws is the per-type timsort workspace
+typedef void (*ext_sort_fn)(void *arr, size_t n, void *ws);
+
+static double ext_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// ============================================================================
+// Whole-buffer transfers, run inline or as pool tasks
+// ============================================================================
+
+typedef struct {
+    int fd;
+    char *buf;
+    size_t len;             // 0: nothing outstanding
+    off_t off;
+    bool write;
+    bool ok;
+    int err;
+} io_task_t;
+
+// pread/pwrite until all len bytes are done; a file that ends early is EIO
+static bool io_full(int fd, char *buf, size_t len, off_t off, bool write) {
+    while (len > 0) {
+        ssize_t r = write ? pwrite(fd, buf, len, off) : pread(fd, buf, len, off);
+        if (r < 0 && errno == EINTR) continue;
+        if (r < 0) return false;
+        if (r == 0) {
+            errno = EIO;
+            return false;
+        }
+        buf += r;
+        len -= (size_t)r;
+        off += r;
+    }
+    return true;
+}
+
+static void io_run(void *arg) {
+    io_task_t *t = (io_task_t *)arg;
+    t->ok = io_full(t->fd, t->buf, t->len, t->off, t->write);
+    t->err = t->ok ? 0 : errno;
+}
+
+// ============================================================================
+// Buffered sequential streams over one run (reader) or the merge output (writer).
+// With a pool a stream owns two buffers: the caller consumes or fills one while
+// a pool task reads or writes the other.
+// ============================================================================
+
+typedef struct {
+    io_task_t io;           // the outstanding transfer
+    tpool_group_t group;
+    tpool_t *pool;          // NULL: transfers run inline on buf[0]
+    int fd;
+    char *buf[2];
+    size_t cap;
+    char *p, *lim;          // reader: unread bytes of the current buffer; writer: free space
+    off_t pos, end;         // reader: next byte to request, end of run; writer: next byte to write
+    bool failed;
+} stream_t;
+
+static void stream_init(stream_t *s, int fd, off_t pos, char *bufs, size_t cap, tpool_t *pool) {
+    memset(s, 0, sizeof(*s));
+    atomic_init(&s->group.pending, 0);
+    s->pool = pool;
+    s->fd = fd;
+    s->buf[0] = bufs;
+    s->buf[1] = pool ? bufs + cap : bufs;
+    s->cap = cap;
+    s->pos = pos;
+}
+
+static void stream_issue(stream_t *s, char *buf, size_t len, bool write) {
+    s->io = (io_task_t){s->fd, buf, len, s->pos, write, false, 0};
+    s->pos += (off_t)len;
+    if (s->pool) {
+        tpool_spawn(s->pool, &s->group, io_run, &s->io);
+    } else {
+        io_run(&s->io);
+    }
+}
+
+// Wait for the outstanding transfer; false (errno set) if it failed
+static bool stream_sync(stream_t *s) {
+    if (s->pool) tpool_wait(s->pool, &s->group);
+    if (s->io.len && !s->io.ok) {
+        errno = s->io.err;
+        s->failed = true;
+        return false;
+    }
+    return true;
+}
+
+static void reader_open(stream_t *s, int fd, ext_run_t run, char *bufs, size_t cap, tpool_t *pool) {
+    stream_init(s, fd, run.off, bufs, cap, pool);
+    s->end = run.off + run.len;
+    if (pool && s->pos < s->end) {
+        size_t left = (size_t)(s->end - s->pos);
+        stream_issue(s, s->buf[0], left < cap ? left : cap, false);
+    }
+}
+
+// Make the next chunk of the run current (and start reading the one after it);
+// false at the end of the run or on error (s->failed)
+static bool reader_next(stream_t *s) {
+    if (!s->pool) {
+        if (s->pos == s->end) return false;
+        size_t left = (size_t)(s->end - s->pos);
+        stream_issue(s, s->buf[0], left < s->cap ? left : s->cap, false);
+    } else if (s->io.len == 0) {
+        return false;
+    }
+    if (!stream_sync(s)) return false;
+
+    s->p = s->io.buf;
+    s->lim = s->io.buf + s->io.len;
+    s->io.len = 0;
+    if (s->pool && s->pos < s->end) {
+        size_t left = (size_t)(s->end - s->pos);
+        stream_issue(s, s->p == s->buf[0] ? s->buf[1] : s->buf[0],
+                     left < s->cap ? left : s->cap, false);
+    }
+    return true;
+}
+
+static void writer_open(stream_t *s, int fd, off_t pos, char *bufs, size_t cap, tpool_t *pool) {
+    stream_init(s, fd, pos, bufs, cap, pool);
+    s->p = bufs;
+    s->lim = bufs + cap;
+}
+
+// Hand the filled part of the current buffer to the file and continue in the other one
+static bool writer_flush(stream_t *s) {
+    char *b = s->lim - s->cap;
+    if (!stream_sync(s)) return false;      // the other buffer's write has finished
+    stream_issue(s, b, (size_t)(s->p - b), true);
+    if (!s->pool && !stream_sync(s)) return false;
+    char *next = (s->pool && b == s->buf[0]) ? s->buf[1] : s->buf[0];
+    s->p = next;
+    s->lim = next + s->cap;
+    return true;
+}
+
+static bool writer_close(stream_t *s) {
+    if (s->p != s->lim - s->cap && !writer_flush(s)) return false;
+    return stream_sync(s);
+}
+
+// ============================================================================
+// k-way merge of runs through a loser tree of run heads
+// ============================================================================
+
+static inline uint64_t load_key(const char *p, size_t width) {
+    if (width == sizeof(uint32_t)) {
+        uint32_t x;
+        memcpy(&x, p, sizeof(x));
+        return x;
+    }
+    uint64_t x;
+    memcpy(&x, p, sizeof(x));
+    return x;
+}
+
+// Merge runs[0..k) of in_fd into out_fd at out_off. Every stream gets io-byte buffers
+// (two with a pool) from arena, which holds (k + 1) of them.
+static bool merge_runs(int in_fd, const ext_run_t *runs, size_t k, int out_fd, off_t out_off,
+                       size_t width, size_t io, tpool_t *pool, char *arena) {
+    size_t stride = (pool ? 2 : 1) * io;
+    stream_t *in = (stream_t *)malloc(k * sizeof(stream_t));
+    kway_tree_t tree;
+    if (!in || !kway_tree_init(&tree, k)) {
+        free(in);
+        return false;
+    }
+
+    stream_t out;
+    writer_open(&out, out_fd, out_off, arena, io, pool);
+    for (size_t r = 0; r < k; r++) {
+        reader_open(&in[r], in_fd, runs[r], arena + (r + 1) * stride, io, pool);
+    }
+
+    bool ok = true;
+    for (size_t r = 0; r < k; r++) {
+        if (reader_next(&in[r])) {
+            kway_tree_set(&tree, r, load_key(in[r].p, width));
+        } else if (in[r].failed) {
+            ok = false;
+        }
+    }
+    kway_tree_build(&tree);
+
+    for (size_t r; ok && (r = kway_tree_top(&tree)) < k; ) {
+        stream_t *s = &in[r];
+        if (out.p == out.lim && !writer_flush(&out)) {
+            ok = false;
+            break;
+        }
+        memcpy(out.p, s->p, width);
+        out.p += width;
+        s->p += width;
+        if (s->p == s->lim && !reader_next(s)) {
+            if (s->failed) {
+                ok = false;
+                break;
+            }
+            kway_tree_drop(&tree);
+        } else {
+            kway_tree_next(&tree, load_key(s->p, width));
+        }
+    }
+    ok = ok && writer_close(&out);
+
+    // outstanding reads (after an error) must finish before the buffers go away
+    int err = errno;
+    for (size_t r = 0; r < k; r++) stream_sync(&in[r]);
+    stream_sync(&out);
+    errno = err;
+    free(in);
+    kway_tree_free(&tree);
+    return ok;
+}
+
+// ============================================================================
+// Driver
+// ============================================================================
+
+// Unlinked temporary file in dir; it disappears when closed
+static int make_temp(const char *dir) {
+    if (!dir) dir = getenv("TMPDIR");
+    if (!dir || !*dir) dir = "/tmp";
+    char path[4096];
+    if (snprintf(path, sizeof(path), "%s/extsort.XXXXXX", dir) >= (int)sizeof(path)) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    int fd = mkstemp(path);
+    if (fd >= 0) unlink(path);
+    return fd;
+}
+
+// Step 1: sort chunk-sized pieces of in_fd into runs[] of run_fd. With a pool the
+// next chunk is read into the second buffer while the current one is sorted and written.
+static bool form_runs(int in_fd, uint64_t bytes, int run_fd, ext_run_t *runs, size_t nruns,
+                      size_t chunk, size_t width, ext_sort_fn sort, void *ws,
+                      tpool_t *pool, char *bufs) {
+    tpool_group_t group = TPOOL_GROUP_INIT;
+    io_task_t rd = {in_fd, bufs, 0, 0, false, true, 0};
+    bool ok = true;
+
+    for (size_t r = 0; r < nruns && ok; r++) {
+        off_t off = (off_t)r * (off_t)chunk;
+        size_t len = (uint64_t)off + chunk <= bytes ? chunk : (size_t)(bytes - (uint64_t)off);
+        char *cur = bufs + (pool ? (r & 1) * chunk : 0);
+
+        if (!pool || r == 0) {
+            rd = (io_task_t){in_fd, cur, len, off, false, false, 0};
+            io_run(&rd);
+        } else {
+            tpool_wait(pool, &group);
+        }
+        if (!rd.ok) {
+            errno = rd.err;
+            ok = false;
+            break;
+        }
+        if (pool && r + 1 < nruns) {
+            off_t next = off + (off_t)chunk;
+            size_t next_len = (uint64_t)next + chunk <= bytes ? chunk : (size_t)(bytes - (uint64_t)next);
+            rd = (io_task_t){in_fd, bufs + ((r + 1) & 1) * chunk, next_len, next, false, false, 0};
+            tpool_spawn(pool, &group, io_run, &rd);
+        }
+
+        sort(cur, len / width, ws);
+        runs[r] = (ext_run_t){off, (off_t)len};
+        ok = io_full(run_fd, cur, len, off, true);
+    }
+
+    int err = errno;
+    if (pool) tpool_wait(pool, &group);
+    errno = err;
+    return ok;
+}
+
+static bool external_sort(const char *in_path, const char *out_path, size_t width,
+                          ext_sort_fn sort, void *ws,
+                          const ext_sort_opts_t *opts, ext_sort_stats_t *stats) {
+    ext_sort_opts_t o = opts ? *opts : (ext_sort_opts_t){0};
+    if (!o.mem_bytes) o.mem_bytes = EXT_MEM;
+    if (!o.io_bytes) o.io_bytes = EXT_IO;
+    tpool_t *pool = o.async_io ? tpool_default() : NULL;
+    size_t nbuf = pool ? 2 : 1;
+    ext_sort_stats_t st = {0};
+
+    int in_fd = -1, out_fd = -1, run_fd = -1;
+    char *bufs = NULL, *arena = NULL;
+    ext_run_t *runs = NULL;
+    bool ok = false;
+    struct stat sb;
+
+    in_fd = open(in_path, O_RDONLY);
+    if (in_fd < 0 || fstat(in_fd, &sb) != 0) goto done;
+    if ((uint64_t)sb.st_size % width != 0) {
+        errno = EINVAL;
+        goto done;
+    }
+    // O_TRUNC on the input itself (same path, symlink or hard link) would destroy it
+    struct stat ob;
+    if (stat(out_path, &ob) == 0 && ob.st_dev == sb.st_dev && ob.st_ino == sb.st_ino) {
+        errno = EINVAL;
+        goto done;
+    }
+    st.bytes = (uint64_t)sb.st_size;
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(in_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    out_fd = open(out_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (out_fd < 0) goto done;
+    if (st.bytes == 0) {
+        ok = true;
+        goto done;
+    }
+
+    // Step 1: the budget holds nbuf chunks plus timsort's scratch for one
+    size_t chunk = o.mem_bytes / (nbuf + 1) / EXT_ALIGN * EXT_ALIGN;
+    if (chunk < EXT_ALIGN) chunk = EXT_ALIGN;
+    size_t nruns = (size_t)((st.bytes + chunk - 1) / chunk);
+    size_t alloc = nruns > 1 ? chunk : (size_t)st.bytes;
+    bufs = (char *)malloc(nbuf * alloc);
+    runs = (ext_run_t *)malloc(nruns * sizeof(ext_run_t));
+    if (!bufs || !runs) goto done;
+    run_fd = nruns > 1 ? make_temp(o.tmp_dir) : out_fd;
+    if (run_fd < 0) goto done;
+
+    double t0 = ext_now();
+    if (!form_runs(in_fd, st.bytes, run_fd, runs, nruns, chunk, width, sort, ws, pool, bufs)) goto done;
+    st.runs = nruns;
+    st.run_sec = ext_now() - t0;
+    free(bufs);
+    bufs = NULL;
+
+    // Step 2: merge fanin runs at a time until the last pass writes out_path
+    t0 = ext_now();
+    size_t fanin = o.mem_bytes / (nbuf * EXT_MIN_IO);     // streams the budget buffers...
+    fanin = fanin > 3 ? fanin - 1 : 2;                      // ... less the output
+    while (nruns > 1) {
+        int dst_fd = nruns <= fanin ? out_fd : make_temp(o.tmp_dir);
+        if (dst_fd < 0) goto done;
+        off_t out_off = 0;
+        size_t groups = (nruns + fanin - 1) / fanin;
+        for (size_t g = 0; g < groups; g++) {
+            ext_run_t *first = runs + g * fanin;
+            size_t k = nruns - g * fanin < fanin ? nruns - g * fanin : fanin;
+            size_t io = o.mem_bytes / (nbuf * (k + 1)) / EXT_ALIGN * EXT_ALIGN;
+            if (io > o.io_bytes) io = o.io_bytes / EXT_ALIGN * EXT_ALIGN;
+            if (io < EXT_ALIGN) io = EXT_ALIGN;
+
+            off_t len = 0;
+            for (size_t r = 0; r < k; r++) len += first[r].len;
+            arena = (char *)malloc((k + 1) * nbuf * io);
+            if (!arena || !merge_runs(run_fd, first, k, dst_fd, out_off, width, io, pool, arena)) {
+                if (dst_fd != out_fd) close(dst_fd);
+                goto done;
+            }
+            free(arena);
+            arena = NULL;
+            runs[g] = (ext_run_t){out_off, len};   // group g only read runs[g * fanin..]
+            out_off += len;
+        }
+        close(run_fd);
+        run_fd = dst_fd;
+        nruns = groups;
+        st.merge_passes++;
+    }
+    st.merge_sec = ext_now() - t0;
+    ok = true;
+
+done:;
+    int err = errno;
+    if (run_fd >= 0 && run_fd != out_fd) close(run_fd);
+    if (out_fd >= 0 && close(out_fd) != 0 && ok) {
+        ok = false;
+        err = errno;
+    }
+    if (in_fd >= 0) close(in_fd);
+    free(bufs);
+    free(arena);
+    free(runs);
+    if (stats) *stats = st;
+    errno = err;
+    return ok;
+}
+
+static void sort_u32(void *arr, size_t n, void *ws) {
+    timsort_with_ws_u32((timsort_ws_u32_t *)ws, (uint32_t *)arr, n);
+}
+
+static void sort_u64(void *arr, size_t n, void *ws) {
+    timsort_with_ws_u64((timsort_ws_u64_t *)ws, (uint64_t *)arr, n);
+}
+
+bool external_sort_u32(const char *in_path, const char *out_path,
+                       const ext_sort_opts_t *opts, ext_sort_stats_t *stats) {
+    timsort_ws_u32_t ws;
+    timsort_ws_init_u32(&ws, 0, TIMSORT_PINGPONG, false);
+    bool ok = external_sort(in_path, out_path, sizeof(uint32_t), sort_u32, &ws, opts, stats);
+    int err = errno;
+    timsort_ws_free_u32(&ws);
+    errno = err;
+    return ok;
+}
+
+bool external_sort_u64(const char *in_path, const char *out_path,
+                       const ext_sort_opts_t *opts, ext_sort_stats_t *stats) {
+    timsort_ws_u64_t ws;
+    timsort_ws_init_u64(&ws, 0, TIMSORT_PINGPONG, false);
+    bool ok = external_sort(in_path, out_path, sizeof(uint64_t), sort_u64, &ws, opts, stats);
+    int err = errno;
+    timsort_ws_free_u64(&ws);
+    errno = err;
+    return ok;
+}
@@ -0,0 +1,40 @@
+#ifndef EXTERNAL_SORT_H
+#define EXTERNAL_SORT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Out-of-core sort of a binary file of raw keys in host byte order, for inputs
+// far larger than RAM:
+//   1. read budget-sized chunks, sort each with timsort() and append it as a run
+//      to an unlinked temporary file
+//   2. k-way merge the runs with large sequential read and write buffers, in
+//      several passes when the budget cannot buffer every run at once
+// An input that fits in one chunk is sorted and written without temporary files.
+typedef struct {
+    size_t mem_bytes;       // memory budget for chunks, scratch and buffers (0: 256 MB)
+    size_t io_bytes;        // largest read/write buffer per merge stream (0: 8 MB)
+    const char *tmp_dir;    // run files (NULL: $TMPDIR, else /tmp)
+    bool async_io;          // double-buffer every stream; reads and writes run as
+                            // tpool_default() tasks while the caller sorts or merges
+} ext_sort_opts_t;
+
+typedef struct {
+    uint64_t bytes;         // input size
+    size_t runs;            // sorted runs written by step 1
+    size_t merge_passes;    // passes over the data in step 2 (0: single run)
+    double run_sec;         // wall time of step 1
+    double merge_sec;       // wall time of step 2
+} ext_sort_stats_t;
+
+// opts and stats may be NULL. Returns false with errno set on I/O or allocation
+// failure, leaving out_path incomplete. EINVAL: file size not a multiple of the key
+// width, or out_path names the input file (directly, by symlink or by hard link),
+// which is then left untouched.
+bool external_sort_u32(const char *in_path, const char *out_path,
+                       const ext_sort_opts_t *opts, ext_sort_stats_t *stats);
+bool external_sort_u64(const char *in_path, const char *out_path,
+                       const ext_sort_opts_t *opts, ext_sort_stats_t *stats);
+
+#endif
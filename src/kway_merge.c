@@ -0,0 +1,329 @@
+#include "kway_merge.h"
+#include "thread_pool.h"
+#include <errno.h>
+#include <stdalign.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define KWAY_MIN_CHUNK (1 << 16)   // fewest output elements worth a task
+
+// ============================================================================
+// Tournament tree
+// ============================================================================
+
+bool kway_tree_init(kway_tree_t *t, size_t k) {
+    t->k = k;
+    t->node = NULL;
+    if (k == 0) return true;
+    t->node = (kway_node_t *)malloc(2 * k * sizeof(kway_node_t));
+    if (!t->node) {
+        errno = ENOMEM;
+        return false;
+    }
+    for (size_t i = 0; i < k; i++) t->node[k + i] = (kway_node_t){UINT64_MAX, k + i};
+    return true;
+}
+
+void kway_tree_free(kway_tree_t *t) {
+    free(t->node);
+    t->node = NULL;
+    t->k = 0;
+}
+
+// Winner of the subtree under p; stores the loser of every match played below it
+static kway_node_t play(kway_node_t *node, size_t k, size_t p) {
+    if (p >= k) return node[p];
+    kway_node_t a = play(node, k, 2 * p);
+    kway_node_t b = play(node, k, 2 * p + 1);
+    bool a_wins = kway_node_less(a, b);
+    node[p] = a_wins ? b : a;
+    return a_wins ? a : b;
+}
+
+void kway_tree_build(kway_tree_t *t) {
+    if (t->k) t->node[0] = play(t->node, t->k, 1);
+}
+
+// ============================================================================
+// Arrays
+// ============================================================================
+
+// Elements of run[0..n) below x, and at most x
+#define DEFINE_BOUNDS(sfx, type)                                                \
+static size_t lower_##sfx(const type *run, size_t n, type x) {                  \
+    size_t lo = 0;                                                              \
+    while (n > 0) {                                                             \
+        size_t half = n / 2;                                                    \
+        if (run[lo + half] < x) {                                               \
+            lo += half + 1;                                                     \
+            n -= half + 1;                                                      \
+        } else {                                                                \
+            n = half;                                                           \
+        }                                                                       \
+    }                                                                           \
+    return lo;                                                                  \
+}                                                                               \
+                                                                                \
+static size_t upper_##sfx(const type *run, size_t n, type x) {                  \
+    size_t lo = 0;                                                              \
+    while (n > 0) {                                                             \
+        size_t half = n / 2;                                                    \
+        if (run[lo + half] <= x) {                                              \
+            lo += half + 1;                                                     \
+            n -= half + 1;                                                      \
+        } else {                                                                \
+            n = half;                                                           \
+        }                                                                       \
+    }                                                                           \
+    return lo;                                                                  \
+}
+
+// Typed kernels behind a void * interface, so one driver serves every key type.
+// A merge kernel advances cur[] and counts left[] down to 0 as it consumes them.
+typedef void (*kway_merge_fn)(const void **cur, size_t *left, size_t k, void *out,
+                              kway_node_t *node);
+typedef void (*kway_split_fn)(const void *const *runs, const size_t *lens, size_t k,
+                              size_t rank, size_t *pos);
+
+// merge_nodes_<sfx>: the merge on a caller-provided 2k-node tree. Once a single
+// input is left, its remainder is copied in one go.
+#define DEFINE_NODE_MERGE(sfx, type)                                            \
+static void merge_nodes_##sfx(const void **cur_, size_t *left, size_t k,        \
+                              void *out_, kway_node_t *node) {                  \
+    const type **cur = (const type **)cur_;                                     \
+    type *out = (type *)out_;                                                   \
+    kway_tree_t t = {k, node};                                                  \
+    size_t live = 0;                                                            \
+    for (size_t i = 0; i < k; i++) {                                            \
+        node[k + i] = (kway_node_t){UINT64_MAX, k + i};                         \
+        if (left[i]) {                                                          \
+            kway_tree_set(&t, i, *cur[i]);                                      \
+            live++;                                                             \
+        }                                                                       \
+    }                                                                           \
+    kway_tree_build(&t);                                                        \
+                                                                                \
+    while (live > 1) {                                                          \
+        size_t s = kway_tree_top(&t);                                           \
+        *out++ = (type)kway_tree_top_key(&t);                                   \
+        if (--left[s]) {                                                        \
+            kway_tree_next(&t, *++cur[s]);                                      \
+        } else {                                                                \
+            kway_tree_drop(&t);                                                 \
+            live--;                                                             \
+        }                                                                       \
+    }                                                                           \
+    if (live) {                                                                 \
+        size_t s = kway_tree_top(&t);                                           \
+        memcpy(out, cur[s], left[s] * sizeof(type));                            \
+        left[s] = 0;                                                            \
+    }                                                                           \
+}
+
+// Public entry points over the kernel merge.
+//
+// split_<sfx>: binary search over key values for the smallest v with at least
+// rank keys <= v. Every run contributes its keys < v, and the keys equal to v
+// still needed come from the lowest-numbered runs first, as in the merge.
+#define DEFINE_KWAY(sfx, type, merge)                                           \
+static void split_##sfx(const void *const *runs_, const size_t *lens, size_t k, \
+                        size_t rank, size_t *pos) {                             \
+    const type *const *runs = (const type *const *)runs_;                       \
+    type lo = 0, hi = 0;                                                        \
+    bool any = false;                                                           \
+    for (size_t i = 0; i < k; i++) {                                            \
+        pos[i] = 0;                                                             \
+        if (!lens[i]) continue;                                                 \
+        if (!any || runs[i][0] < lo) lo = runs[i][0];                           \
+        if (!any || runs[i][lens[i] - 1] > hi) hi = runs[i][lens[i] - 1];       \
+        any = true;                                                             \
+    }                                                                           \
+    if (!any || rank == 0) return;                                              \
+                                                                                \
+    while (lo < hi) {                                                           \
+        type v = lo + (hi - lo) / 2;                                            \
+        size_t le = 0;                                                          \
+        for (size_t i = 0; i < k && le < rank; i++) {                           \
+            le += upper_##sfx(runs[i], lens[i], v);                             \
+        }                                                                       \
+        if (le >= rank) {                                                       \
+            hi = v;                                                             \
+        } else {                                                                \
+            lo = v + 1;                                                         \
+        }                                                                       \
+    }                                                                           \
+                                                                                \
+    size_t less = 0;                                                            \
+    for (size_t i = 0; i < k; i++) {                                            \
+        pos[i] = lower_##sfx(runs[i], lens[i], lo);                             \
+        less += pos[i];                                                         \
+    }                                                                           \
+    for (size_t i = 0; i < k && less < rank; i++) {                             \
+        size_t eq = upper_##sfx(runs[i], lens[i], lo) - pos[i];                 \
+        size_t take = rank - less < eq ? rank - less : eq;                      \
+        pos[i] += take;                                                         \
+        less += take;                                                           \
+    }                                                                           \
+}                                                                               \
+                                                                                \
+bool kway_merge_##sfx(const type *const *runs, const size_t *lens, size_t k, type *out) { \
+    return merge_parallel((const void *const *)runs, lens, k, out, 1,           \
+                          sizeof(type), merge, split_##sfx);                     \
+}                                                                               \
+                                                                                \
+bool kway_merge_parallel_##sfx(const type *const *runs, const size_t *lens, size_t k, \
+                               type *out, size_t threads) {                     \
+    return merge_parallel((const void *const *)runs, lens, k, out, threads,     \
+                          sizeof(type), merge, split_##sfx);                     \
+}                                                                               \
+                                                                                \
+void kway_split_##sfx(const type *const *runs, const size_t *lens, size_t k,    \
+                      size_t rank, size_t *pos) {                               \
+    split_##sfx((const void *const *)runs, lens, k, rank, pos);                 \
+}
+
+typedef struct {
+    const void *const *runs;
+    const size_t *lens;
+    size_t k;
+    size_t esz;             // element size
+    size_t rank;            // first output of this range
+    size_t *cut;            // split at rank; the next k entries are the next range's
+    char *out;
+    const void **cur;       // k cursors and remaining counts for the merge kernel
+    size_t *left;
+    kway_node_t *node;      // 2k tree nodes
+    kway_merge_fn merge;
+    kway_split_fn split;
+    alignas(64) char pad[64];
+} kway_task_t;
+
+static void split_task(void *arg) {
+    kway_task_t *t = (kway_task_t *)arg;
+    t->split(t->runs, t->lens, t->k, t->rank, t->cut);
+}
+
+static void merge_task(void *arg) {
+    kway_task_t *t = (kway_task_t *)arg;
+    const size_t *next = t->cut + t->k;
+    for (size_t i = 0; i < t->k; i++) {
+        t->cur[i] = (const char *)t->runs[i] + t->cut[i] * t->esz;
+        t->left[i] = next[i] - t->cut[i];
+    }
+    t->merge(t->cur, t->left, t->k, t->out + t->rank * t->esz, t->node);
+}
+
+static void run_phase(tpool_t *pool, void (*fn)(void *), kway_task_t *tasks, size_t n) {
+    if (n == 0) return;
+    tpool_group_t group = TPOOL_GROUP_INIT;
+    for (size_t t = 1; t < n; t++) {
+        tpool_spawn(pool, &group, fn, &tasks[t]);
+    }
+    fn(&tasks[0]);
+    if (pool) tpool_wait(pool, &group);
+}
+
+// Cut the output into P equal ranges, split the P - 1 interior cuts in parallel,
+// then merge every range on its own tree. Everything is allocated up front, so a
+// failure leaves out untouched.
+static bool merge_parallel(const void *const *runs, const size_t *lens, size_t k,
+                           void *out, size_t threads, size_t esz,
+                           kway_merge_fn merge, kway_split_fn split) {
+    if (k == 0) return true;
+    size_t total = 0;
+    for (size_t i = 0; i < k; i++) total += lens[i];
+    tpool_t *pool = threads != 1 && total >= 2 * KWAY_MIN_CHUNK ? tpool_default() : NULL;
+    size_t P = (threads < 1 && pool) ? tpool_size(pool) : threads;
+    if (P > total / KWAY_MIN_CHUNK) P = total / KWAY_MIN_CHUNK;
+    if (!pool || P < 1) P = 1;
+
+    // Per range: 2k nodes, k cursors, k counts; plus P + 1 rows of k cuts
+    char *mem = (char *)malloc(P * k * (2 * sizeof(kway_node_t) + sizeof(void *) + sizeof(size_t))
+                               + (P + 1) * k * sizeof(size_t));
+    if (!mem) {
+        errno = ENOMEM;
+        return false;
+    }
+    kway_node_t *node = (kway_node_t *)mem;
+    const void **cur = (const void **)(node + 2 * P * k);
+    size_t *left = (size_t *)(cur + P * k);
+    size_t *cut = left + P * k;
+
+    kway_task_t tasks[P];
+    for (size_t t = 0; t < P; t++) {
+        tasks[t] = (kway_task_t){
+            .runs = runs, .lens = lens, .k = k, .esz = esz,
+            .rank = total / P * t + (t < total % P ? t : total % P),
+            .cut = cut + t * k, .out = (char *)out,
+            .cur = cur + t * k, .left = left + t * k, .node = node + 2 * t * k,
+            .merge = merge, .split = split,
+        };
+    }
+    memset(cut, 0, k * sizeof(size_t));
+    memcpy(cut + P * k, lens, k * sizeof(size_t));
+
+    run_phase(pool, split_task, tasks + 1, P - 1);
+    run_phase(pool, merge_task, tasks, P);
+    free(mem);
+    return true;
+}
+
+DEFINE_BOUNDS(u32, uint32_t)
+DEFINE_BOUNDS(u64, uint64_t)
+DEFINE_NODE_MERGE(u32, uint32_t)
+DEFINE_NODE_MERGE(u64, uint64_t)
+
+// uint32 keys and their input index fit one 64-bit word, key << 32 | src, so a
+// match is a single integer compare and the replay compiles to conditional
+// moves. Exhausted inputs are UINT64_MAX, above every live word while k < 2^32;
+// the live count ensures the winner is never an exhausted input.
+static uint64_t play_packed(uint64_t *node, size_t k, size_t p) {
+    if (p >= k) return node[p];
+    uint64_t a = play_packed(node, k, 2 * p);
+    uint64_t b = play_packed(node, k, 2 * p + 1);
+    node[p] = a < b ? b : a;
+    return a < b ? a : b;
+}
+
+static void merge_packed_u32(const void **cur_, size_t *left, size_t k, void *out_,
+                             kway_node_t *node_) {
+    if (k >= UINT32_MAX) {
+        merge_nodes_u32(cur_, left, k, out_, node_);
+        return;
+    }
+    const uint32_t **cur = (const uint32_t **)cur_;
+    uint32_t *out = (uint32_t *)out_;
+    uint64_t *node = (uint64_t *)node_;
+    size_t live = 0;
+    for (size_t i = 0; i < k; i++) {
+        node[k + i] = left[i] ? (uint64_t)*cur[i] << 32 | i : UINT64_MAX;
+        live += left[i] != 0;
+    }
+    node[0] = play_packed(node, k, 1);
+
+    while (live > 1) {
+        uint64_t w = node[0];
+        size_t s = (uint32_t)w;
+        *out++ = (uint32_t)(w >> 32);
+        uint64_t x = UINT64_MAX;
+        if (--left[s]) {
+            x = (uint64_t)*++cur[s] << 32 | s;
+        } else {
+            live--;
+        }
+        for (size_t p = (k + s) / 2; p > 0; p /= 2) {
+            uint64_t l = node[p];
+            node[p] = l < x ? x : l;
+            x = l < x ? l : x;
+        }
+        node[0] = x;
+    }
+    if (live) {
+        size_t s = (uint32_t)node[0];
+        memcpy(out, cur[s], left[s] * sizeof(uint32_t));
+        left[s] = 0;
+    }
+}
+
+DEFINE_KWAY(u32, uint32_t, merge_packed_u32)
+DEFINE_KWAY(u64, uint64_t, merge_nodes_u64)
@@ -0,0 +1,102 @@
+#ifndef KWAY_MERGE_H
+#define KWAY_MERGE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// k-way merge through a tournament (loser) tree: every internal node keeps the
+// loser of the match played there and node 0 the overall winner, so advancing
+// the winning input replays one leaf-to-root path of ceil(log2 k) comparisons
+// against stored losers, with no sibling loads. All k inputs are merged in one
+// pass over the data. Ties go to the lower input index, so the merge is stable.
+
+// ============================================================================
+// Streams: the caller owns the inputs and feeds the tree their head keys
+// ============================================================================
+
+typedef struct {
+    uint64_t key;
+    size_t src;             // input index; >= k once that input is exhausted
+} kway_node_t;
+
+typedef struct {
+    size_t k;
+    kway_node_t *node;      // [0]: winner, [1..k): losers, [k..2k): heads for kway_tree_build
+} kway_tree_t;
+
+// false (errno ENOMEM) if allocation fails; k == 0 is an empty tree. Every input
+// starts exhausted until kway_tree_set() gives it a head.
+bool kway_tree_init(kway_tree_t *t, size_t k);
+void kway_tree_free(kway_tree_t *t);
+
+// Before kway_tree_build(): the first key of input src
+static inline void kway_tree_set(kway_tree_t *t, size_t src, uint64_t key) {
+    t->node[t->k + src] = (kway_node_t){key, src};
+}
+
+// Play every match once the heads are set
+void kway_tree_build(kway_tree_t *t);
+
+// Input holding the smallest head, or a value >= k when every input is exhausted
+static inline size_t kway_tree_top(const kway_tree_t *t) {
+    return t->k ? t->node[0].src : 0;
+}
+static inline uint64_t kway_tree_top_key(const kway_tree_t *t) {
+    return t->node[0].key;
+}
+
+static inline bool kway_node_less(kway_node_t a, kway_node_t b) {
+    return a.key < b.key || (a.key == b.key && a.src < b.src);
+}
+
+// Replay the path from leaf k + src (src: the winning input) with x as its new head
+static inline void kway_tree_replay_(kway_tree_t *t, size_t src, kway_node_t x) {
+    kway_node_t *node = t->node;
+    for (size_t p = (t->k + src) / 2; p > 0; p /= 2) {
+        if (kway_node_less(node[p], x)) {
+            kway_node_t l = node[p];
+            node[p] = x;
+            x = l;
+        }
+    }
+    node[0] = x;
+}
+
+// The winning input moved on to key
+static inline void kway_tree_next(kway_tree_t *t, uint64_t key) {
+    size_t src = t->node[0].src;
+    kway_tree_replay_(t, src, (kway_node_t){key, src});
+}
+
+// The winning input is exhausted
+static inline void kway_tree_drop(kway_tree_t *t) {
+    size_t src = t->node[0].src;
+    kway_tree_replay_(t, src, (kway_node_t){UINT64_MAX, t->k + src});
+}
+
+// ============================================================================
+// Arrays
+// ============================================================================
+
+// Merge the sorted runs[i][0..lens[i]) into out (sum of lens elements, not
+// overlapping any run). Returns false (errno ENOMEM, out untouched) only if the
+// tree cannot be allocated.
+bool kway_merge_u32(const uint32_t *const *runs, const size_t *lens, size_t k, uint32_t *out);
+bool kway_merge_u64(const uint64_t *const *runs, const size_t *lens, size_t k, uint64_t *out);
+
+// Cut the merge after its first rank outputs: pos[i] receives how many of them
+// come from runs[i]. Merging runs[i][pos_a[i]..pos_b[i]) for two ranks a <= b
+// yields exactly out[a..b), so disjoint output ranges can be merged independently.
+void kway_split_u32(const uint32_t *const *runs, const size_t *lens, size_t k, size_t rank, size_t *pos);
+void kway_split_u64(const uint64_t *const *runs, const size_t *lens, size_t k, size_t rank, size_t *pos);
+
+// kway_merge_*() with the output cut into equal ranges, each split and merged as
+// a task on the process-wide worker pool (thread_pool.h). threads == 0 uses one
+// task per pool worker; small outputs are merged on the calling thread.
+bool kway_merge_parallel_u32(const uint32_t *const *runs, const size_t *lens, size_t k,
+                             uint32_t *out, size_t threads);
+bool kway_merge_parallel_u64(const uint64_t *const *runs, const size_t *lens, size_t k,
+                             uint64_t *out, size_t threads);
+
+#endif
@@ -0,0 +1,101 @@
+#include "mmap_sort.h"
+#include "radix_sort.h"
+#include "parallel_sort.h"
+#include "sort_alloc.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+static double mmap_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+bool mmap_sort_u32(const char *path, sort_alg_t alg, mmap_sort_stats_t *stats) {
+    mmap_sort_stats_t st = {alg, 0, 0, 0.0, 0.0, 0.0};
+    struct stat sb;
+    int fd = open(path, O_RDWR);
+    if (fd < 0) return false;
+    if (fstat(fd, &sb) != 0) {
+        int err = errno;
+        close(fd);
+        errno = err;
+        return false;
+    }
+    if (sb.st_size % sizeof(uint32_t) != 0) {
+        close(fd);
+        errno = EINVAL;
+        return false;
+    }
+    st.bytes = (size_t)sb.st_size;
+    size_t n = st.bytes / sizeof(uint32_t);
+    if (n < 2) {
+        close(fd);
+        if (alg == MMAP_SORT_AUTO) st.alg = SORT_TIMSORT;   // nothing to sort
+        if (stats) *stats = st;
+        return true;
+    }
+
+    double t0 = mmap_now();
+    uint32_t *arr = (uint32_t *)mmap(NULL, st.bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    int err = errno;
+    close(fd);                      // the mapping keeps the file open
+    if (arr == (uint32_t *)MAP_FAILED) {
+        errno = err;
+        return false;
+    }
+    madvise(arr, st.bytes, MADV_WILLNEED);
+    if (alg == MMAP_SORT_AUTO) alg = sort_auto_plan(arr, n).alg;
+    st.map_sec = mmap_now() - t0;
+
+    t0 = mmap_now();
+    uint32_t *scratch = NULL;
+    switch (alg) {
+        case SORT_TIMSORT:
+            scratch = (uint32_t *)sort_buf_alloc(n * sizeof(uint32_t), false);
+            // without scratch this is the TIMSORT_INPLACE merge
+            timsort_with_buf_u32(arr, n, scratch, n, TIMSORT_PINGPONG);
+            break;
+        case SORT_PARALLEL:
+            st.scratch_bytes = sort_parallel(arr, n, 0);
+            break;
+        case SORT_COUNTING:
+            if (counting_sort_u32(arr, n, NULL)) break;
+            alg = SORT_RADIX_LSD;       // too many distinct keys
+            // fall through
+        case SORT_RADIX_LSD:
+            scratch = (uint32_t *)sort_buf_alloc(n * sizeof(uint32_t), false);
+            if (scratch) {
+                radix_sort_u32(arr, n, scratch);
+                break;
+            }
+            alg = SORT_RADIX_MSD;       // no scratch: sort in place instead
+            // fall through
+        case SORT_RADIX_MSD:
+            radix_sort_msd_u32(arr, n);
+            break;
+        default:
+            munmap(arr, st.bytes);
+            errno = EINVAL;
+            return false;
+    }
+    if (scratch) {
+        sort_buf_free(scratch);
+        st.scratch_bytes = n * sizeof(uint32_t);
+    }
+    st.alg = alg;
+    st.sort_sec = mmap_now() - t0;
+
+    t0 = mmap_now();
+    bool ok = msync(arr, st.bytes, MS_SYNC) == 0;
+    err = errno;
+    st.sync_sec = mmap_now() - t0;
+    munmap(arr, st.bytes);
+    if (stats) *stats = st;
+    errno = err;
+    return ok;
+}
@@ -0,0 +1,30 @@
+#ifndef MMAP_SORT_H
+#define MMAP_SORT_H
+
+#include "sort_auto.h"
+
+// Sort a file of raw uint32 keys (host byte order) in place through a MAP_SHARED
+// mapping: no read() into a private copy and no write() back, so the page cache
+// holds the only copy. The mapping is advised MADV_WILLNEED only: timsort revisits
+// it once per merge level and merge_hi walks it backwards, so MADV_SEQUENTIAL
+// would let the kernel drop pages it still needs. Scratch for timsort and LSD
+// radix comes from sort_buf_alloc() (huge pages when large). If that cannot be allocated,
+// timsort merges in place and LSD radix becomes in-place MSD radix. The result is
+// written back with msync(MS_SYNC).
+#define MMAP_SORT_AUTO ((sort_alg_t)-1)    // let sort_auto_plan() choose
+
+typedef struct {
+    sort_alg_t alg;         // algorithm that ran
+    size_t bytes;           // file size
+    size_t scratch_bytes;   // anonymous scratch mapped
+    double map_sec;         // mmap + madvise
+    double sort_sec;
+    double sync_sec;        // msync
+} mmap_sort_stats_t;
+
+// alg: any sort_alg_t or MMAP_SORT_AUTO; stats may be NULL. Returns false with
+// errno set on failure (EINVAL: size not a multiple of 4); a failed msync may
+// leave the file partly sorted.
+bool mmap_sort_u32(const char *path, sort_alg_t alg, mmap_sort_stats_t *stats);
+
+#endif
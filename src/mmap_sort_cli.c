@@ -0,0 +1,37 @@
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include "mmap_sort.h"
+
+// Sort a raw uint32 key file in place:  ./mmap_sort <file> [algorithm]
+// algorithm: auto (default), timsort, radix_lsd, radix_msd, counting, parallel
+int main(int argc, char *argv[]) {
+    static const sort_alg_t algs[] = {
+        SORT_TIMSORT, SORT_RADIX_LSD, SORT_RADIX_MSD, SORT_COUNTING, SORT_PARALLEL
+    };
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <file> [auto|timsort|radix_lsd|radix_msd|counting|parallel]\n", argv[0]);
+        return 2;
+    }
+
+    sort_alg_t alg = MMAP_SORT_AUTO;
+    if (argc > 2 && strcmp(argv[2], "auto") != 0) {
+        size_t i = 0;
+        while (i < sizeof(algs) / sizeof(algs[0]) && strcmp(argv[2], sort_alg_name(algs[i])) != 0) i++;
+        if (i == sizeof(algs) / sizeof(algs[0])) {
+            fprintf(stderr, "unknown algorithm: %s\n", argv[2]);
+            return 2;
+        }
+        alg = algs[i];
+    }
+
+    mmap_sort_stats_t st;
+    if (!mmap_sort_u32(argv[1], alg, &st)) {
+        fprintf(stderr, "%s: %s\n", argv[1], strerror(errno));
+        return 1;
+    }
+    printf("%s: %zu keys (%.1f MB), %s, scratch %.1f MB\n", argv[1], st.bytes / sizeof(uint32_t),
+           st.bytes / (1024.0 * 1024.0), sort_alg_name(st.alg), st.scratch_bytes / (1024.0 * 1024.0));
+    printf("map %.3f s, sort %.3f s, msync %.3f s\n", st.map_sec, st.sort_sec, st.sync_sec);
+    return 0;
+}
@@ -0,0 +1,127 @@
+#include "parallel_sort.h"
+#include "thread_pool.h"
+#include "sort_alloc.h"
+#include <stdalign.h>
+
+#define PAR_MIN_CHUNK (1 << 16)   // fewest elements worth a task
+#define OVERSAMPLE 32             // samples per bucket
+#define MAX_BUCKETS 256
+
+typedef struct {
+    T *arr;
+    T *temp;
+    size_t lo, hi;          // input block, later bucket [lo, hi)
+    const T *splitters;     // P-1 ascending keys
+    size_t P;
+    size_t *counts;         // this block's count per bucket, then its write offsets
+    alignas(64) char pad[64];
+} part_task_t;
+
+// Bucket of x = number of splitters x may follow, so equal keys share a bucket
+static inline size_t bucket_of(T x, const T *splitters, size_t nsplit) {
+    size_t lo = 0, n = nsplit;
+    while (n > 0) {
+        size_t half = n / 2;
+        if (cmp(splitters[lo + half], x)) {
+            lo += half + 1;
+            n -= half + 1;
+        } else {
+            n = half;
+        }
+    }
+    return lo;
+}
+
+static void count_task(void *arg) {
+    part_task_t *t = (part_task_t *)arg;
+    memset(t->counts, 0, t->P * sizeof(size_t));
+    for (size_t i = t->lo; i < t->hi; i++) {
+        t->counts[bucket_of(t->arr[i], t->splitters, t->P - 1)]++;
+    }
+}
+
+static void scatter_task(void *arg) {
+    part_task_t *t = (part_task_t *)arg;
+    for (size_t i = t->lo; i < t->hi; i++) {
+        T x = t->arr[i];
+        t->temp[t->counts[bucket_of(x, t->splitters, t->P - 1)]++] = x;
+    }
+}
+
+// Sort bucket temp[lo, hi) using arr[lo, hi) as scratch, then copy it back
+static void bucket_task(void *arg) {
+    part_task_t *t = (part_task_t *)arg;
+    size_t n = t->hi - t->lo;
+    timsort_with_buf(t->temp + t->lo, n, t->arr + t->lo, n, TIMSORT_PINGPONG);
+    memcpy(t->arr + t->lo, t->temp + t->lo, n * sizeof(T));
+}
+
+static void run_phase(tpool_t *pool, void (*fn)(void *), part_task_t *tasks, size_t n) {
+    tpool_group_t group = TPOOL_GROUP_INIT;
+    for (size_t t = 1; t < n; t++) {
+        tpool_spawn(pool, &group, fn, &tasks[t]);
+    }
+    fn(&tasks[0]);
+    tpool_wait(pool, &group);
+}
+
+size_t sort_parallel(T *arr, size_t n, size_t threads) {
+    tpool_t *pool = n >= 2 * PAR_MIN_CHUNK ? tpool_default() : NULL;
+    size_t P = (threads < 1 && pool) ? tpool_size(pool) : threads;
+    if (P > n / PAR_MIN_CHUNK) P = n / PAR_MIN_CHUNK;
+    if (P > MAX_BUCKETS) P = MAX_BUCKETS;
+    // The tasks, counts, sample and splitters live past the end of temp, not on
+    // the caller's stack: P * P counts reach 512 KB and callers may be pool workers
+    size_t nsample = P * OVERSAMPLE;
+    size_t meta = 64 + P * sizeof(part_task_t) + (P * P + P + 1) * sizeof(size_t)
+                + (nsample + P) * sizeof(T);
+    T *temp = (pool && P > 1) ? (T *)sort_buf_alloc(n * sizeof(T) + meta, false) : NULL;
+    if (!temp) return timsort_mode(arr, n, TIMSORT_PINGPONG);
+    part_task_t *tasks = (part_task_t *)(((uintptr_t)(temp + n) + 63) & ~(uintptr_t)63);
+    size_t *counts = (size_t *)(tasks + P);
+    size_t *bucket_start = counts + P * P;
+    T *sample = (T *)(bucket_start + P + 1);
+    T *splitters = sample + nsample;
+
+    // Evenly spaced sample, sorted; every OVERSAMPLE-th one is a splitter
+    for (size_t i = 0; i < nsample; i++) {
+        sample[i] = arr[(n / nsample) * i + (n / nsample) / 2];
+    }
+    timsort_mode(sample, nsample, TIMSORT_INPLACE);
+    for (size_t b = 1; b < P; b++) {
+        splitters[b - 1] = sample[b * OVERSAMPLE];
+    }
+
+    size_t block = (n + P - 1) / P;
+    for (size_t t = 0; t < P; t++) {
+        tasks[t].arr       = arr;
+        tasks[t].temp      = temp;
+        tasks[t].lo        = t * block < n ? t * block : n;
+        tasks[t].hi        = (t + 1) * block < n ? (t + 1) * block : n;
+        tasks[t].splitters = splitters;
+        tasks[t].P         = P;
+        tasks[t].counts    = counts + t * P;
+    }
+    run_phase(pool, count_task, tasks, P);
+
+    // Bucket-major prefix sum: bucket b of block t lands after bucket b of blocks < t
+    size_t sum = 0;
+    for (size_t b = 0; b < P; b++) {
+        bucket_start[b] = sum;
+        for (size_t t = 0; t < P; t++) {
+            size_t c = counts[t * P + b];
+            counts[t * P + b] = sum;
+            sum += c;
+        }
+    }
+    bucket_start[P] = sum;
+    run_phase(pool, scatter_task, tasks, P);
+
+    for (size_t b = 0; b < P; b++) {
+        tasks[b].lo = bucket_start[b];
+        tasks[b].hi = bucket_start[b + 1];
+    }
+    run_phase(pool, bucket_task, tasks, P);
+    sort_buf_free(temp);
+    return n * sizeof(T) + meta;
+}
@@ -0,0 +1,14 @@
+#ifndef PARALLEL_SORT_H
+#define PARALLEL_SORT_H
+
+#include "timsort.h"
+
+// Stable parallel samplesort on the process-wide worker pool (thread_pool.h):
+// P-1 splitters from an oversampled set, one counting pass and one scatter pass
+// in input order, then the adaptive timsort on every bucket. threads == 0 uses
+// one task per pool worker. Inputs too small to give two tasks 64K elements, or
+// a failed scratch allocation, fall back to a sequential timsort. Returns the
+// scratch bytes allocated (n elements plus bookkeeping, or timsort's).
+size_t sort_parallel(T *arr, size_t n, size_t threads);
+
+#endif
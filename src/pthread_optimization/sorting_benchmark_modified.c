@@ -6,12 +6,15 @@
 #include <sys/time.h>
 #include <pthread.h>
 #include <stdalign.h>
+#include "../thread_pool.h"
+#include "../kway_merge.h"
+#include "../parallel_sort.h"
 
 // ============================================================================
 // CONFIGURATION - Adjust these for experiments
 // ============================================================================
 
-typedef uint32_t T;  // Data type: uint32_t or float
+typedef uint32_t T;  // Data type: must match the T of timsort.h (sort_parallel)
 
 // RUN sizes to test (tune based on L1 cache size)
 // EPYC 9354P: 32KB L1d per core -> ~8192 uint32_t
@@ -23,6 +26,12 @@ typedef uint32_t T;  // Data type: uint32_t or float
 #define RUN_XLARGE  256
 #define RUN_CACHE   512  // For cache-line aligned experiments
 
+// Parallel paths hand each task at least this many elements (256KB of uint32_t);
+// inputs too small to give two tasks that much are sorted on the calling thread
+#ifndef PAR_MIN_CHUNK
+#define PAR_MIN_CHUNK (1 << 16)
+#endif
+
 // ============================================================================
 // UTILITY FUNCTIONS
 // ============================================================================
@@ -124,7 +133,7 @@ static void insertion_sort_range(T *arr, size_t left, size_t right) {
     for (size_t i = left + 1; i <= right; i++) {
         T temp = arr[i];
         size_t j = i;
-        while (j > left && cmp_le(temp, arr[j - 1])) {
+        while (j > left && !cmp_le(arr[j - 1], temp)) {   // strict: equal keys keep their order
             arr[j] = arr[j - 1];
             j--;
         }
@@ -225,35 +234,114 @@ static void timsort_prefetch(T *arr, size_t size, size_t run_size, T *temp) {
 }
 
 // ===========================
-// Pairwise merge round (single-thread)
-// Merge adjacent sorted blocks into temp, then copy back to arr.
-// Place this after merge/merge_prefetch definitions.
+// Pairwise merge round (Merge Path, all pool workers)
+// Merge adjacent sorted blocks of src into dst. The round's output is cut into
+// one equal-size segment per thread; a segment may cover the tail of one merge
+// and the head of the next, and co_rank() finds where each cut falls in the two
+// input blocks, so even the final full-array merge runs on every thread.
 // ===========================
-static void pairwise_merge_round(T* arr, T* temp,
+
+// Number of elements taken from a in the first k outputs of the stable merge of
+// a[0..na) and b[0..nb) (ties go to a)
+static size_t co_rank(size_t k, const T* a, size_t na, const T* b, size_t nb) {
+    size_t lo = k > nb ? k - nb : 0;
+    size_t hi = k < na ? k : na;
+    while (lo < hi) {
+        size_t i = lo + (hi - lo) / 2;
+        size_t j = k - i;
+        if (j > 0 && i < na && cmp_le(a[i], b[j - 1])) {
+            lo = i + 1;     // a[i] is output before b[j-1]: take more of a
+        } else {
+            hi = i;
+        }
+    }
+    return lo;
+}
+
+static void merge_range(const T* a, size_t na, const T* b, size_t nb, T* dst) {
+    size_t i = 0, j = 0, k = 0;
+    while (i < na && j < nb) {
+        if (cmp_le(a[i], b[j])) {
+            dst[k++] = a[i++];
+        } else {
+            dst[k++] = b[j++];
+        }
+    }
+    memcpy(dst + k, a + i, (na - i) * sizeof(T));
+    memcpy(dst + k + (na - i), b + j, (nb - j) * sizeof(T));
+}
+
+typedef struct {
+    const T* src;
+    T* dst;
+    size_t nblocks;
+    const size_t* starts;
+    const size_t* ends;
+    size_t out_lo;      // this thread's output segment [out_lo, out_hi)
+    size_t out_hi;
+    alignas(64) char pad[64];
+} MergeTask;
+
+static void merge_segment_task(void* arg) {
+    MergeTask* t = (MergeTask*)arg;
+
+    for (size_t p = 0; p < t->nblocks; p += 2) {
+        size_t left  = t->starts[p];
+        size_t right = t->ends[p + 1 < t->nblocks ? p + 1 : p] + 1;
+        if (right <= t->out_lo) continue;
+        if (left >= t->out_hi) break;
+
+        size_t lo = left  > t->out_lo ? left  : t->out_lo;
+        size_t hi = right < t->out_hi ? right : t->out_hi;
+
+        if (p + 1 == t->nblocks) {
+            // odd block out: carried over unchanged
+            memcpy(t->dst + lo, t->src + lo, (hi - lo) * sizeof(T));
+            continue;
+        }
+
+        const T* a = t->src + left;
+        size_t na = t->ends[p] + 1 - left;
+        const T* b = t->src + t->ends[p] + 1;
+        size_t nb = right - left - na;
+        size_t i0 = co_rank(lo - left, a, na, b, nb);
+        size_t i1 = co_rank(hi - left, a, na, b, nb);
+        size_t j0 = (lo - left) - i0;
+        size_t j1 = (hi - left) - i1;
+        merge_range(a + i0, i1 - i0, b + j0, j1 - j0, t->dst + lo);
+    }
+}
+
+static void pairwise_merge_round(tpool_t* pool,
+                                 const T* src, T* dst,
                                  size_t nblocks,
                                  const size_t* starts,
-                                 const size_t* ends) {
+                                 const size_t* ends,
+                                 size_t threads) {
     if (nblocks == 0) return;
-    size_t npairs = nblocks / 2;
+    size_t total = ends[nblocks - 1] + 1;
+    size_t P = (threads < 1) ? 1 : threads;
+    if (P > total / PAR_MIN_CHUNK) P = total / PAR_MIN_CHUNK ? total / PAR_MIN_CHUNK : 1;
+    size_t seg = (total + P - 1) / P;
 
-    for (size_t p = 0; p < npairs; p++) {
-        size_t left  = starts[2*p];
-        size_t mid   = ends[2*p];
-        size_t right = ends[2*p + 1];
-        // Use existing merge (or switch to merge_prefetch if desired)
-        merge(arr, left, mid, right, temp);
-        // Alternative:
-        // merge_prefetch(arr, left, mid, right, temp);
-    }
+    MergeTask tasks[P];
+    tpool_group_t group = TPOOL_GROUP_INIT;
 
-    if (nblocks % 2 == 1) {
-        size_t left  = starts[nblocks - 1];
-        size_t right = ends[nblocks - 1];
-        memcpy(&temp[left], &arr[left], (right - left + 1) * sizeof(T));
+    for (size_t t = 0; t < P; t++) {
+        tasks[t].src     = src;
+        tasks[t].dst     = dst;
+        tasks[t].nblocks = nblocks;
+        tasks[t].starts  = starts;
+        tasks[t].ends    = ends;
+        tasks[t].out_lo  = t * seg < total ? t * seg : total;
+        tasks[t].out_hi  = (t + 1) * seg < total ? (t + 1) * seg : total;
     }
-
-    size_t total_right = ends[nblocks - 1];
-    memcpy(arr, temp, (total_right + 1) * sizeof(T));
+    // the calling thread takes segment 0, then helps with the rest
+    for (size_t t = 1; t < P; t++) {
+        tpool_spawn(pool, &group, merge_segment_task, &tasks[t]);
+    }
+    merge_segment_task(&tasks[0]);
+    tpool_wait(pool, &group);
 }
 
 
@@ -271,30 +359,49 @@ static void pairwise_merge_round(T* arr, T* temp,
 static void radix_sort_lsd(T *arr, size_t size, T *temp) {
     if (size <= 1) return;
     
-    size_t count[RADIX_SIZE];
+    enum { PASSES = (int)(sizeof(T) * 8 / RADIX_BITS) };
+    size_t count[PASSES][RADIX_SIZE];
     
-    // Process each byte (4 passes for uint32_t)
-    for (int shift = 0; shift < (int)(sizeof(T) * 8); shift += RADIX_BITS) {
-        // Count occurrences
-        memset(count, 0, sizeof(count));
-        for (size_t i = 0; i < size; i++) {
-            size_t digit = (arr[i] >> shift) & RADIX_MASK;
-            count[digit]++;
+    // One read pass builds the histograms of every digit (4 for uint32_t)
+    memset(count, 0, sizeof(count));
+    for (size_t i = 0; i < size; i++) {
+        T x = arr[i];
+        for (int p = 0; p < PASSES; p++) {
+            count[p][(x >> (p * RADIX_BITS)) & RADIX_MASK]++;
         }
+    }
+    
+    // Passes alternate between arr and temp instead of copying back
+    T *src = arr, *dst = temp;
+    for (int p = 0; p < PASSES; p++) {
+        int shift = p * RADIX_BITS;
         
-        // Compute prefix sums (cumulative count)
-        for (size_t i = 1; i < RADIX_SIZE; i++) {
-            count[i] += count[i - 1];
+        // Every key has the same digit here (e.g. the top byte of rand() values
+        // or small key ranges): the pass would not move anything
+        if (count[p][(src[0] >> shift) & RADIX_MASK] == size) continue;
+        
+        // Exclusive prefix sums: first output slot of each digit
+        size_t sum = 0;
+        for (size_t d = 0; d < RADIX_SIZE; d++) {
+            size_t c = count[p][d];
+            count[p][d] = sum;
+            sum += c;
         }
         
-        // Place elements in sorted order (iterate backwards for stability)
-        for (size_t i = size; i > 0; i--) {
-            size_t digit = (arr[i-1] >> shift) & RADIX_MASK;
-            temp[--count[digit]] = arr[i-1];
+        // Place elements front to back (stable)
+        for (size_t i = 0; i < size; i++) {
+            T x = src[i];
+            dst[count[p][(x >> shift) & RADIX_MASK]++] = x;
         }
         
-        // Copy back
-        memcpy(arr, temp, size * sizeof(T));
+        T *swap = src;
+        src = dst;
+        dst = swap;
+    }
+    
+    // Odd number of executed passes: result is in temp
+    if (src != arr) {
+        memcpy(arr, src, size * sizeof(T));
     }
 }
 
@@ -325,14 +432,13 @@ void (*func)(T*, size_t, size_t, T*);
 alignas(64) char pad[64];            
 } ThreadTask;
 
-static void* thread_sort_entry(void* arg) {
-ThreadTask* t = (ThreadTask*)arg;
-if (t->right < t->left) return NULL;
-size_t size = t->right - t->left + 1; 
-if (size > 1) {
-t->func(t->arr + t->left, size, t->run_param, t->temp_local);
-}
-return NULL;
+static void sort_chunk_task(void* arg) {
+    ThreadTask* t = (ThreadTask*)arg;
+    if (t->right < t->left) return;
+    size_t size = t->right - t->left + 1;
+    if (size > 1) {
+        t->func(t->arr + t->left, size, t->run_param, t->temp_local);
+    }
 }
 
 typedef void (*sort_func_t)(T *arr, size_t size, size_t param, T *temp);
@@ -363,86 +469,155 @@ static void wrap_radix_hybrid(T *arr, size_t size, size_t unused, T *temp) {
 }
 
 // ===========================
-// Parallel Timsort wrapper (Method A)
-// Place this in the wrapper functions section (after wrap_timsort/_prefetch),
-// and before the SortAlgorithm algorithms[] definition.
+// NUMA placement
+// Arrays are cut into one contiguous share per pool node (tpool_nodes()). Linux
+// places a page on the node of the thread that first writes it, so main() has
+// every share of work and temp first touched by a task bound to its node, and
+// the parallel timsort sorts and merges each share on that node.
 // ===========================
 
-// If not already at the top of file, ensure these includes exist only once:
-// #include <pthread.h>
-// #include <stdalign.h>
-
-// typedef struct {
-//     T* arr;
-//     size_t left;
-//     size_t right;
-//     T* temp_local;        // per-thread temporary buffer
-//     size_t run_param;     // RUN size for timsort
-//     // Correct function pointer type (matches sort_func_t signature but with T* arr)
-//     void (*func)(T*, size_t, size_t, T*);
-//     alignas(64) char pad[64]; // padding to avoid false sharing on task structs
-// } ThreadTask;
-
-// static void* thread_sort_entry(void* arg) {
-//     ThreadTask* t = (ThreadTask*)arg;
-//     if (t->right < t->left) return NULL;
-//     size_t len = t->right - t->left + 1;
-//     if (len > 1) {
-//         // Call the sorting function on this block using the per-thread temp
-//         t->func(t->arr + t->left, len, t->run_param, t->temp_local);
-//     }
-//     return NULL;
-// }
+// First element of share j of an n-element array cut into nn shares, rounded
+// down to a 4 KB page of T
+static size_t node_share_lo(size_t n, size_t j, size_t nn) {
+    if (j >= nn) return n;
+    return (n / nn * j) & ~(size_t)(4096 / sizeof(T) - 1);
+}
 
-static void wrap_timsort_parallel(T *arr, size_t size, size_t threads, T *temp) {
-    if (size <= 1) return;
+static void spawn_at(tpool_t* pool, tpool_group_t* group, size_t nn, size_t node,
+                     void (*fn)(void*), void* arg) {
+    if (nn > 1) {
+        tpool_spawn_on(pool, group, node, fn, arg);
+    } else {
+        tpool_spawn(pool, group, fn, arg);
+    }
+}
 
-    size_t P = (threads < 1) ? 1 : threads;
+typedef struct {
+    T* p;
+    size_t n;
+    alignas(64) char pad[64];
+} TouchTask;
 
-    // Partition: evenly divide, align to 16 elements (64B cache line for uint32_t)
-    size_t chunk = (size + P - 1) / P;
-    chunk = (chunk + 15) & ~((size_t)15); // round up to multiple of 16
+static void touch_task(void* arg) {
+    TouchTask* t = (TouchTask*)arg;
+    memset(t->p, 0, t->n * sizeof(T));
+}
 
-    pthread_t* th     = (pthread_t*)malloc(P * sizeof(pthread_t));
-    ThreadTask* tasks = (ThreadTask*)malloc(P * sizeof(ThreadTask));
-    T** temp_locals   = (T**)malloc(P * sizeof(T*));
+// Fault in every share of a fresh (untouched) buffer on its node; a no-op on
+// single-node hosts
+static void numa_first_touch(T* buf, size_t size) {
+    tpool_t* pool = tpool_default();
+    size_t nn = pool ? tpool_nodes(pool) : 1;
+    if (nn < 2) return;
 
-    size_t* starts = (size_t*)malloc(P * sizeof(size_t));
-    size_t* ends   = (size_t*)malloc(P * sizeof(size_t));
-    size_t nblocks = 0;
+    TouchTask tasks[nn];
+    tpool_group_t group = TPOOL_GROUP_INIT;
+    for (size_t j = 0; j < nn; j++) {
+        size_t lo = node_share_lo(size, j, nn);
+        tasks[j].p = buf + lo;
+        tasks[j].n = node_share_lo(size, j + 1, nn) - lo;
+        tpool_spawn_on(pool, &group, j, touch_task, &tasks[j]);
+    }
+    tpool_wait(pool, &group);
+}
 
-    for (size_t t = 0; t < P; t++) {
-        size_t left = t * chunk;
-        if (left >= size) break;
-        size_t right = left + chunk - 1;
-        if (right >= size) right = size - 1;
+// ===========================
+// Parallel Timsort wrapper (Method A)
+// Chunks are sorted and merged as tasks on the process-wide worker pool, so a
+// call creates no threads. threads == 0 uses every worker.
+//
+// PAR_MERGE_NUMA gives every node's share of arr P/nn chunks, sorted by tasks
+// bound to that node. Two k-way passes (loser tree, kway_merge.h) follow:
+//   1. each node merges its own chunks into its share of temp: node-local
+//   2. the nn node runs are merged back into arr, every node writing its own
+//      share; only this last level reads across nodes
+// On one node that is the single k-way merge plus a parallel copy back.
+// PAR_MERGE_FLAT ignores the topology; PAR_MERGE_PAIRWISE (and any k-way
+// allocation failure) merges through log2(P) pairwise rounds instead.
+// ===========================
 
-        size_t len = (right >= left) ? (right - left + 1) : 0;
-        temp_locals[t] = (len > 0) ? (T*)malloc(len * sizeof(T)) : NULL;
+typedef enum { PAR_MERGE_NUMA, PAR_MERGE_FLAT, PAR_MERGE_PAIRWISE } par_merge_t;
 
-        tasks[t].arr        = arr;
-        tasks[t].left       = left;
-        tasks[t].right      = right;
-        tasks[t].temp_local = temp_locals[t];
-        tasks[t].run_param  = RUN_MEDIUM; // tune if needed
-        // Function pointer points to timsort_with_run (matches void (*)(T*, size, run, temp))
-        tasks[t].func       = timsort_with_run;
+// Outputs [lo, hi) of the k-way merge of runs, written to dst + lo
+typedef struct {
+    const T* const* runs;
+    const size_t* lens;
+    size_t k;
+    size_t lo, hi;
+    T* dst;
+    int ok;
+    alignas(64) char pad[64];
+} RangeMergeTask;
 
-        starts[nblocks] = left;
-        ends[nblocks]   = right;
-        nblocks++;
+static void range_merge_task(void* arg) {
+    RangeMergeTask* t = (RangeMergeTask*)arg;
+    size_t k = t->k;
+    size_t from[k], to[k];
+    const T* sub[k];
+    kway_split_u32(t->runs, t->lens, k, t->lo, from);
+    kway_split_u32(t->runs, t->lens, k, t->hi, to);
+    for (size_t i = 0; i < k; i++) {
+        sub[i] = t->runs[i] + from[i];
+        to[i] -= from[i];
     }
+    t->ok = kway_merge_u32(sub, to, k, t->dst + t->lo);
+}
 
-    for (size_t t = 0; t < nblocks; t++) {
-        pthread_create(&th[t], NULL, thread_sort_entry, &tasks[t]);
+// Node j's part of one k-way level: outputs [lo, hi) of the merge of runs[0..k),
+// written to dst + rank and cut into ntasks ranges
+typedef struct {
+    const T* const* runs;
+    const size_t* lens;
+    size_t k;
+    size_t lo, hi;
+    T* dst;
+    size_t ntasks;
+} MergeGroup;
+
+// Run every group's ranges on its node; false if any range failed to allocate
+static int merge_level(tpool_t* pool, size_t nn, const MergeGroup* groups, size_t P) {
+    RangeMergeTask tasks[P];
+    size_t node_of[P];
+    size_t n = 0;
+    for (size_t j = 0; j < nn; j++) {
+        const MergeGroup* g = &groups[j];
+        size_t len = g->hi - g->lo;
+        for (size_t r = 0; r < g->ntasks; r++) {
+            tasks[n].runs = g->runs;
+            tasks[n].lens = g->lens;
+            tasks[n].k    = g->k;
+            tasks[n].lo   = g->lo + len / g->ntasks * r;
+            tasks[n].hi   = r + 1 == g->ntasks ? g->hi : g->lo + len / g->ntasks * (r + 1);
+            tasks[n].dst  = g->dst;
+            tasks[n].ok   = 0;
+            node_of[n] = j;
+            n++;
+        }
     }
-    for (size_t t = 0; t < nblocks; t++) {
-        pthread_join(th[t], NULL);
+
+    tpool_group_t group = TPOOL_GROUP_INIT;
+    for (size_t t = nn > 1 ? 0 : 1; t < n; t++) {
+        spawn_at(pool, &group, nn, node_of[t], range_merge_task, &tasks[t]);
     }
+    if (nn == 1) range_merge_task(&tasks[0]);
+    tpool_wait(pool, &group);
+
+    int ok = 1;
+    for (size_t t = 0; t < n; t++) ok &= tasks[t].ok;
+    return ok;
+}
 
-    // Tree-style pairwise merge rounds until one block remains
+// Tree-style pairwise merge rounds over the blocks of src (arr or temp) until one
+// block remains; rounds alternate between the two buffers, so data moves once per
+// level instead of twice, and the result ends up in arr
+static void pairwise_merge_all(tpool_t* pool, T* arr, T* temp, T* src,
+                               size_t* starts, size_t* ends, size_t nblocks, size_t P) {
+    T* dst = src == arr ? temp : arr;
     while (nblocks > 1) {
-        pairwise_merge_round(arr, temp, nblocks, starts, ends);
+        pairwise_merge_round(pool, src, dst, nblocks, starts, ends, P);
+        T* swap = src;
+        src = dst;
+        dst = swap;
         size_t new_blocks = (nblocks / 2) + (nblocks % 2);
         for (size_t i = 0; i < new_blocks; i++) {
             starts[i] = starts[2*i];
@@ -450,16 +625,259 @@ static void wrap_timsort_parallel(T *arr, size_t size, size_t threads, T *temp)
         }
         nblocks = new_blocks;
     }
+    if (src != arr) {
+        pairwise_merge_round(pool, src, arr, 1, starts, ends, P);   // parallel copy back
+    }
+}
+
+static void timsort_parallel(T *arr, size_t size, size_t threads, T *temp, par_merge_t mode) {
+    if (size <= 1) return;
+
+    tpool_t* pool = tpool_default();
+    size_t P = (threads < 1 && pool) ? tpool_size(pool) : threads;
+    if (P > size / PAR_MIN_CHUNK) P = size / PAR_MIN_CHUNK;
+    if (!pool || P <= 1) {
+        timsort_with_run(arr, size, RUN_MEDIUM, temp);   // sequential cutoff
+        return;
+    }
+    size_t nn = mode == PAR_MERGE_FLAT ? 1 : tpool_nodes(pool);
+    if (nn > P) nn = P;
+
+    // Partition: node j's share gets P/nn chunks (one more for the first P % nn),
+    // evenly divided and aligned to 16 elements (64B cache line for uint32_t)
+    ThreadTask tasks[P];
+    size_t starts[P];
+    size_t ends[P];
+    size_t chunk_node[P];
+    size_t first[nn + 1];       // chunks of node j: [first[j], first[j + 1])
+    size_t share[nn + 1];       // elements of node j: [share[j], share[j + 1])
+    size_t nblocks = 0;
+
+    for (size_t j = 0; j <= nn; j++) share[j] = node_share_lo(size, j, nn);
+    for (size_t j = 0; j < nn; j++) {
+        size_t pj = P / nn + (j < P % nn);
+        size_t chunk = (share[j + 1] - share[j] + pj - 1) / pj;
+        chunk = (chunk + 15) & ~((size_t)15); // round up to multiple of 16
+        first[j] = nblocks;
+
+        for (size_t t = 0; t < pj; t++) {
+            size_t left = share[j] + t * chunk;
+            if (left >= share[j + 1]) break;
+            size_t right = left + chunk - 1;
+            if (right >= share[j + 1]) right = share[j + 1] - 1;
+
+            // Blocks are disjoint, so each task sorts with its own slice of temp
+            tasks[nblocks].arr        = arr;
+            tasks[nblocks].left       = left;
+            tasks[nblocks].right      = right;
+            tasks[nblocks].temp_local = temp + left;
+            tasks[nblocks].run_param  = RUN_MEDIUM; // tune if needed
+            tasks[nblocks].func       = timsort_with_run;
+
+            starts[nblocks]     = left;
+            ends[nblocks]       = right;
+            chunk_node[nblocks] = j;
+            nblocks++;
+        }
+    }
+    first[nn] = nblocks;
+
+    // On one node the calling thread takes chunk 0; otherwise every chunk goes
+    // to a worker of its node
+    tpool_group_t group = TPOOL_GROUP_INIT;
+    for (size_t t = nn > 1 ? 0 : 1; t < nblocks; t++) {
+        spawn_at(pool, &group, nn, chunk_node[t], sort_chunk_task, &tasks[t]);
+    }
+    if (nn == 1) sort_chunk_task(&tasks[0]);
+    tpool_wait(pool, &group);
+
+    if (mode != PAR_MERGE_PAIRWISE) {
+        const T* runs[P];
+        size_t lens[P];
+        const T* node_runs[nn];
+        size_t node_lens[nn];
+        MergeGroup groups[nn];
+        for (size_t i = 0; i < nblocks; i++) {
+            runs[i] = arr + starts[i];
+            lens[i] = ends[i] + 1 - starts[i];
+        }
+
+        // Level 1: node j merges its chunks into its share of temp
+        for (size_t j = 0; j < nn; j++) {
+            size_t len = share[j + 1] - share[j];
+            groups[j] = (MergeGroup){runs + first[j], lens + first[j], first[j + 1] - first[j],
+                                     0, len, temp + share[j], first[j + 1] - first[j]};
+            node_runs[j] = temp + share[j];
+            node_lens[j] = len;
+        }
+        if (!merge_level(pool, nn, groups, nblocks)) {
+            pairwise_merge_all(pool, arr, temp, arr, starts, ends, nblocks, P);
+            return;
+        }
+
+        // Level 2: the nn node runs are merged into arr, node j writing its share
+        for (size_t j = 0; j < nn; j++) {
+            groups[j] = (MergeGroup){node_runs, node_lens, nn,
+                                     share[j], share[j + 1], arr, first[j + 1] - first[j]};
+        }
+        if (!merge_level(pool, nn, groups, nblocks)) {
+            for (size_t j = 0; j < nn; j++) {
+                starts[j] = share[j];
+                ends[j]   = share[j + 1] - 1;
+            }
+            pairwise_merge_all(pool, arr, temp, temp, starts, ends, nn, P);
+        }
+        return;
+    }
+
+    pairwise_merge_all(pool, arr, temp, arr, starts, ends, nblocks, P);
+}
+
+static void wrap_timsort_parallel(T *arr, size_t size, size_t threads, T *temp) {
+    timsort_parallel(arr, size, threads, temp, PAR_MERGE_NUMA);
+}
+
+static void wrap_timsort_parallel_flat(T *arr, size_t size, size_t threads, T *temp) {
+    timsort_parallel(arr, size, threads, temp, PAR_MERGE_FLAT);
+}
+
+static void wrap_timsort_parallel_pairwise(T *arr, size_t size, size_t threads, T *temp) {
+    timsort_parallel(arr, size, threads, temp, PAR_MERGE_PAIRWISE);
+}
+
+
+// ===========================
+// Parallel samplesort wrapper (Method B)
+// The library's sort_parallel() (parallel_sort.h): P-1 splitters cut the key
+// range into P buckets, one count and one scatter pass in input order move every
+// element into its bucket, and the buckets are sorted independently. Data moves
+// twice in total instead of once per merge level. It allocates its own scratch
+// and bookkeeping, so temp is unused.
+// ===========================
+
+static void wrap_samplesort_parallel(T *arr, size_t size, size_t threads, T *temp) {
+    (void)temp;
+    sort_parallel(arr, size, threads);
+}
+
+
+// ===========================
+// Parallel LSD radix wrapper
+// Per digit: every task histograms its own slice, a digit-major prefix sum over
+// (digit, slice) hands each task a disjoint output range per digit, and each task
+// scatters its slice front to back. No atomics in the hot loops, and slices keep
+// their order within a digit, so every pass is stable. The first count covers all
+// digits at once, which is enough to skip digits shared by every key (later
+// passes recount, since scattering changes what each slice holds). Passes
+// alternate between arr and temp.
+// ===========================
+
+enum { RADIX_PASSES = (int)(sizeof(T) * 8 / RADIX_BITS) };
+
+typedef struct {
+    const T* src;
+    T* dst;
+    size_t lo, hi;              // slice [lo, hi)
+    int shift;
+    alignas(64) size_t count[RADIX_PASSES][RADIX_SIZE];  // first count: every digit
+    size_t offset[RADIX_SIZE];  // current pass: slice histogram, then write positions
+} RadixTask;
+
+static void radix_count_all_task(void* arg) {
+    RadixTask* t = (RadixTask*)arg;
+    memset(t->count, 0, sizeof(t->count));
+    for (size_t i = t->lo; i < t->hi; i++) {
+        T x = t->src[i];
+        for (int p = 0; p < RADIX_PASSES; p++) {
+            t->count[p][(x >> (p * RADIX_BITS)) & RADIX_MASK]++;
+        }
+    }
+}
 
-    // Cleanup
+static void radix_count_task(void* arg) {
+    RadixTask* t = (RadixTask*)arg;
+    memset(t->offset, 0, sizeof(t->offset));
+    for (size_t i = t->lo; i < t->hi; i++) {
+        t->offset[(t->src[i] >> t->shift) & RADIX_MASK]++;
+    }
+}
+
+static void radix_scatter_task(void* arg) {
+    RadixTask* t = (RadixTask*)arg;
+    for (size_t i = t->lo; i < t->hi; i++) {
+        T x = t->src[i];
+        t->dst[t->offset[(x >> t->shift) & RADIX_MASK]++] = x;
+    }
+}
+
+static void run_radix_phase(tpool_t* pool, void (*fn)(void*), RadixTask* tasks, size_t n) {
+    tpool_group_t group = TPOOL_GROUP_INIT;
+    for (size_t t = 1; t < n; t++) {
+        tpool_spawn(pool, &group, fn, &tasks[t]);
+    }
+    fn(&tasks[0]);
+    tpool_wait(pool, &group);
+}
+
+static void wrap_radix_parallel(T *arr, size_t size, size_t threads, T *temp) {
+    if (size <= 1) return;
+
+    tpool_t* pool = tpool_default();
+    size_t P = (threads < 1 && pool) ? tpool_size(pool) : threads;
+    if (P > size / PAR_MIN_CHUNK) P = size / PAR_MIN_CHUNK;
+    // About 10 KB of histograms per task: on the heap, not the caller's stack
+    RadixTask* tasks = (pool && P > 1) ? (RadixTask*)aligned_alloc(64, P * sizeof(RadixTask)) : NULL;
+    if (!tasks) {
+        radix_sort_lsd(arr, size, temp);   // sequential cutoff
+        return;
+    }
+
+    size_t slice = (size + P - 1) / P;
     for (size_t t = 0; t < P; t++) {
-        if (temp_locals[t]) free(temp_locals[t]);
+        tasks[t].src = arr;
+        tasks[t].lo  = t * slice < size ? t * slice : size;
+        tasks[t].hi  = (t + 1) * slice < size ? (t + 1) * slice : size;
+    }
+    run_radix_phase(pool, radix_count_all_task, tasks, P);
+
+    T* src = arr;
+    T* dst = temp;
+    int first = 1;      // slices still hold the input, so count[p] is current
+    for (int p = 0; p < RADIX_PASSES; p++) {
+        int shift = p * RADIX_BITS;
+
+        size_t d0 = (arr[0] >> shift) & RADIX_MASK;
+        size_t same = 0;
+        for (size_t t = 0; t < P; t++) same += tasks[t].count[p][d0];
+        if (same == size) continue;   // every key has this digit
+
+        for (size_t t = 0; t < P; t++) {
+            tasks[t].src   = src;
+            tasks[t].dst   = dst;
+            tasks[t].shift = shift;
+            if (first) memcpy(tasks[t].offset, tasks[t].count[p], sizeof(tasks[t].offset));
+        }
+        if (!first) run_radix_phase(pool, radix_count_task, tasks, P);
+        first = 0;
+
+        size_t sum = 0;
+        for (size_t d = 0; d < RADIX_SIZE; d++) {
+            for (size_t t = 0; t < P; t++) {
+                size_t c = tasks[t].offset[d];
+                tasks[t].offset[d] = sum;
+                sum += c;
+            }
+        }
+        run_radix_phase(pool, radix_scatter_task, tasks, P);
+
+        T* swap = src;
+        src = dst;
+        dst = swap;
+    }
+    if (src != arr) {
+        memcpy(arr, src, size * sizeof(T));
     }
-    free(temp_locals);
-    free(starts);
-    free(ends);
     free(tasks);
-    free(th);
 }
 
 
@@ -508,7 +926,7 @@ int main(int argc, char *argv[]) {
     printf("=== Sorting Benchmark ===\n");
     printf("Array size: %zu elements (%.3f GB)\n", size, size_gb);
     printf("Data type: %zu bytes\n", sizeof(T));
-    printf("Runs per test: %d\n\n", num_runs);
+    printf("Runs per test: %d\n", num_runs);
     
     // Allocate arrays
     T *source = (T *)malloc(size * sizeof(T));
@@ -519,6 +937,12 @@ int main(int argc, char *argv[]) {
         fprintf(stderr, "Failed to allocate memory!\n");
         return 1;
     }
+
+    // Place each node's share of the sort buffers before anything else touches them
+    tpool_t *pool = tpool_default();
+    printf("NUMA nodes: %zu\n\n", pool ? tpool_nodes(pool) : (size_t)1);
+    numa_first_touch(work, size);
+    numa_first_touch(temp, size);
     
     // Define algorithms to test
     SortAlgorithm algorithms[] = {
@@ -540,6 +964,29 @@ int main(int argc, char *argv[]) {
         {"timsort_parallel_t4",  wrap_timsort_parallel, 4},
         {"timsort_parallel_t8",  wrap_timsort_parallel, 8},
         {"timsort_parallel_t16", wrap_timsort_parallel, 16},
+        {"timsort_parallel_t32", wrap_timsort_parallel, 32},
+        {"timsort_parallel_t64", wrap_timsort_parallel, 64},
+        {"timsort_parallel_auto", wrap_timsort_parallel, 0},  // one task per pool worker
+        {"timsort_flat_t8",       wrap_timsort_parallel_flat, 8},       // NUMA topology ignored
+        {"timsort_flat_auto",     wrap_timsort_parallel_flat, 0},
+        {"timsort_pairwise_t8",   wrap_timsort_parallel_pairwise, 8},   // log2(P) merge rounds
+        {"timsort_pairwise_auto", wrap_timsort_parallel_pairwise, 0},
+        // --- Parallel samplesort (Method B) ---
+        {"samplesort_parallel_t2",  wrap_samplesort_parallel, 2},
+        {"samplesort_parallel_t4",  wrap_samplesort_parallel, 4},
+        {"samplesort_parallel_t8",  wrap_samplesort_parallel, 8},
+        {"samplesort_parallel_t16", wrap_samplesort_parallel, 16},
+        {"samplesort_parallel_t32", wrap_samplesort_parallel, 32},
+        {"samplesort_parallel_t64", wrap_samplesort_parallel, 64},
+        {"samplesort_parallel_auto", wrap_samplesort_parallel, 0},
+        // --- Parallel LSD radix ---
+        {"radix_parallel_t2",  wrap_radix_parallel, 2},
+        {"radix_parallel_t4",  wrap_radix_parallel, 4},
+        {"radix_parallel_t8",  wrap_radix_parallel, 8},
+        {"radix_parallel_t16", wrap_radix_parallel, 16},
+        {"radix_parallel_t32", wrap_radix_parallel, 32},
+        {"radix_parallel_t64", wrap_radix_parallel, 64},
+        {"radix_parallel_auto", wrap_radix_parallel, 0},
 
     };
     size_t num_algorithms = sizeof(algorithms) / sizeof(algorithms[0]);
@@ -0,0 +1,258 @@
+#include "radix_sort.h"
+#include "stream_store.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define RADIX_BITS 8
+#define RADIX_SIZE (1 << RADIX_BITS)  // 256 buckets
+#define RADIX_MASK (RADIX_SIZE - 1)
+#define MSD_CUTOFF 64   // MSD buckets this small are finished by insertion sort
+#define COUNT_MAX_RANGE    (1u << 16)  // counting sort: direct table when max-min < this
+#define COUNT_MAX_DISTINCT 256         // ... else hash table, given up past this many keys
+#define COUNT_HASH_BITS    10
+#define COUNT_HASH_SLOTS   (1u << COUNT_HASH_BITS)
+_Static_assert(COUNT_HASH_SLOTS >= 2 * COUNT_MAX_DISTINCT, "counting sort hash table too small");
+
+// Keys are read through these so float/double arrays can be handled as bits
+typedef uint32_t __attribute__((may_alias)) bits32_t;
+typedef uint64_t __attribute__((may_alias)) bits64_t;
+
+// Order-preserving maps to unsigned keys
+#define KEY_U32(x) (x)
+#define KEY_I32(x) ((x) ^ 0x80000000u)                                   // flip sign bit
+#define KEY_F32(x) ((x) ^ ((uint32_t)-(int32_t)((x) >> 31) | 0x80000000u)) // negative: flip all bits
+#define KEY_U64(x) (x)
+#define KEY_I64(x) ((x) ^ 0x8000000000000000ull)
+#define KEY_F64(x) ((x) ^ ((uint64_t)-(int64_t)((x) >> 63) | 0x8000000000000000ull))
+
+// All digit histograms in one read pass, digits shared by every key skipped,
+// passes alternating between arr and temp (same scheme as radix_sort_lsd in
+// sorting_benchmark.c). Arrays of stream_min_bytes or more scatter through
+// write-combining buffers with streaming stores.
+#define DEFINE_RADIX(name, bits_t, KEY)                                         \
+DEFINE_STREAM_SCATTER(name##_scatter_stream, bits_t, KEY)                       \
+                                                                                \
+static void name(bits_t *arr, size_t n, bits_t *temp) {                         \
+    enum { PASSES = (int)(sizeof(bits_t) * 8 / RADIX_BITS) };                   \
+    if (n <= 1) return;                                                         \
+                                                                                \
+    size_t count[PASSES][RADIX_SIZE];                                           \
+    memset(count, 0, sizeof(count));                                            \
+    for (size_t i = 0; i < n; i++) {                                            \
+        bits_t k = KEY(arr[i]);                                                 \
+        for (int p = 0; p < PASSES; p++) {                                      \
+            count[p][(k >> (p * RADIX_BITS)) & RADIX_MASK]++;                   \
+        }                                                                       \
+    }                                                                           \
+                                                                                \
+    bool stream = stream_wanted(n * sizeof(bits_t));                            \
+    bits_t *src = arr, *dst = temp;                                             \
+    for (int p = 0; p < PASSES; p++) {                                          \
+        int shift = p * RADIX_BITS;                                             \
+        if (count[p][(KEY(src[0]) >> shift) & RADIX_MASK] == n) continue;       \
+                                                                                \
+        size_t sum = 0;                                                         \
+        for (size_t d = 0; d < RADIX_SIZE; d++) {                               \
+            size_t c = count[p][d];                                             \
+            count[p][d] = sum;                                                  \
+            sum += c;                                                           \
+        }                                                                       \
+        if (stream) {                                                           \
+            name##_scatter_stream(src, dst, n, shift, count[p]);                \
+        } else {                                                                \
+            for (size_t i = 0; i < n; i++) {                                    \
+                bits_t x = src[i];                                              \
+                dst[count[p][(KEY(x) >> shift) & RADIX_MASK]++] = x;            \
+            }                                                                   \
+        }                                                                       \
+                                                                                \
+        bits_t *swap = src;                                                     \
+        src = dst;                                                              \
+        dst = swap;                                                             \
+    }                                                                           \
+    if (src != arr && stream) {                                                 \
+        stream_copy(arr, src, n * sizeof(bits_t));                              \
+        stream_fence();                                                         \
+    } else if (src != arr) {                                                    \
+        memcpy(arr, src, n * sizeof(bits_t));                                   \
+    }                                                                           \
+}
+
+DEFINE_RADIX(lsd_u32, bits32_t, KEY_U32)
+DEFINE_RADIX(lsd_i32, bits32_t, KEY_I32)
+DEFINE_RADIX(lsd_f32, bits32_t, KEY_F32)
+DEFINE_RADIX(lsd_u64, bits64_t, KEY_U64)
+DEFINE_RADIX(lsd_i64, bits64_t, KEY_I64)
+DEFINE_RADIX(lsd_f64, bits64_t, KEY_F64)
+
+void radix_sort_u32(uint32_t *arr, size_t n, uint32_t *temp) {
+    lsd_u32((bits32_t *)arr, n, (bits32_t *)temp);
+}
+
+void radix_sort_u64(uint64_t *arr, size_t n, uint64_t *temp) {
+    lsd_u64((bits64_t *)arr, n, (bits64_t *)temp);
+}
+
+void radix_sort_i32(int32_t *arr, size_t n, int32_t *temp) {
+    lsd_i32((bits32_t *)arr, n, (bits32_t *)temp);
+}
+
+void radix_sort_i64(int64_t *arr, size_t n, int64_t *temp) {
+    lsd_i64((bits64_t *)arr, n, (bits64_t *)temp);
+}
+
+void radix_sort_f32(float *arr, size_t n, float *temp) {
+    _Static_assert(sizeof(float) == sizeof(uint32_t), "float must be 32-bit");
+    lsd_f32((bits32_t *)arr, n, (bits32_t *)temp);
+}
+
+void radix_sort_f64(double *arr, size_t n, double *temp) {
+    _Static_assert(sizeof(double) == sizeof(uint64_t), "double must be 64-bit");
+    lsd_f64((bits64_t *)arr, n, (bits64_t *)temp);
+}
+
+// ============================================================================
+// In-place MSD radix (American flag sort)
+// ============================================================================
+
+static void insertion_sort_u32(uint32_t *arr, size_t n) {
+    for (size_t i = 1; i < n; i++) {
+        uint32_t x = arr[i];
+        size_t j = i;
+        while (j > 0 && arr[j - 1] > x) {
+            arr[j] = arr[j - 1];
+            j--;
+        }
+        arr[j] = x;
+    }
+}
+
+static void msd_u32(uint32_t *arr, size_t n, int shift) {
+    for (;;) {
+        if (n <= MSD_CUTOFF) {
+            insertion_sort_u32(arr, n);
+            return;
+        }
+
+        size_t count[RADIX_SIZE] = {0};
+        uint32_t first = arr[0], diff = 0;
+        for (size_t i = 0; i < n; i++) {
+            uint32_t x = arr[i];
+            count[(x >> shift) & RADIX_MASK]++;
+            diff |= x ^ first;
+        }
+        if (diff == 0) return;                      // uniform bucket
+
+        if (count[(first >> shift) & RADIX_MASK] == n) {
+            // This digit is shared by every key: jump to the highest differing one
+            int top = 31 - __builtin_clz(diff);
+            shift = top - top % RADIX_BITS;
+            continue;
+        }
+
+        size_t head[RADIX_SIZE], tail[RADIX_SIZE];
+        size_t sum = 0;
+        for (size_t d = 0; d < RADIX_SIZE; d++) {
+            head[d] = sum;
+            sum += count[d];
+            tail[d] = sum;
+        }
+
+        // Swap each misplaced key straight into the next free slot of its bucket
+        for (size_t d = 0; d < RADIX_SIZE; d++) {
+            while (head[d] < tail[d]) {
+                uint32_t x = arr[head[d]];
+                size_t dx = (x >> shift) & RADIX_MASK;
+                while (dx != d) {
+                    uint32_t y = arr[head[dx]];
+                    arr[head[dx]++] = x;
+                    x = y;
+                    dx = (x >> shift) & RADIX_MASK;
+                }
+                arr[head[d]++] = x;
+            }
+        }
+
+        if (shift == 0) return;
+        for (size_t d = 0; d < RADIX_SIZE; d++) {
+            if (count[d] > 1) {
+                msd_u32(arr + tail[d] - count[d], count[d], shift - RADIX_BITS);
+            }
+        }
+        return;
+    }
+}
+
+void radix_sort_msd_u32(uint32_t *arr, size_t n) {
+    msd_u32(arr, n, 32 - RADIX_BITS);
+}
+
+// ============================================================================
+// Counting sort for low-cardinality keys
+// ============================================================================
+
+typedef struct {
+    uint32_t key;
+    size_t count;       // 0: slot empty
+} count_slot_t;
+
+static int cmp_slot(const void *a, const void *b) {
+    uint32_t x = ((const count_slot_t *)a)->key, y = ((const count_slot_t *)b)->key;
+    return (x > y) - (x < y);
+}
+
+bool counting_sort_u32(uint32_t *arr, size_t n, size_t *scratch_bytes) {
+    if (scratch_bytes) *scratch_bytes = 0;
+    if (n <= 1) return true;
+
+    uint32_t lo = arr[0], hi = arr[0];
+    for (size_t i = 1; i < n; i++) {
+        uint32_t x = arr[i];
+        lo = x < lo ? x : lo;
+        hi = x > hi ? x : hi;
+    }
+
+    // Small range: one histogram pass over arr, then a sequential fill
+    if (hi - lo < COUNT_MAX_RANGE) {
+        size_t range = (size_t)(hi - lo) + 1;
+        size_t *count = (size_t *)calloc(range, sizeof(size_t));
+        if (count) {
+            for (size_t i = 0; i < n; i++) count[arr[i] - lo]++;
+            size_t k = 0;
+            for (size_t v = 0; v < range; v++) {
+                for (size_t c = count[v]; c > 0; c--) arr[k++] = lo + (uint32_t)v;
+            }
+            free(count);
+            if (scratch_bytes) *scratch_bytes = range * sizeof(size_t);
+            return true;
+        }
+    }
+
+    // Wide range: count distinct keys in an open-addressing table and give up
+    // (arr untouched) once there are too many of them
+    count_slot_t table[COUNT_HASH_SLOTS];
+    memset(table, 0, sizeof(table));
+    size_t distinct = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint32_t x = arr[i];
+        size_t h = (x * 2654435761u) >> (32 - COUNT_HASH_BITS);
+        while (table[h].count && table[h].key != x) h = (h + 1) & (COUNT_HASH_SLOTS - 1);
+        if (!table[h].count) {
+            if (++distinct > COUNT_MAX_DISTINCT) return false;
+            table[h].key = x;
+        }
+        table[h].count++;
+    }
+
+    size_t m = 0;
+    for (size_t h = 0; h < COUNT_HASH_SLOTS; h++) {
+        if (table[h].count) table[m++] = table[h];
+    }
+    qsort(table, m, sizeof(count_slot_t), cmp_slot);
+    size_t k = 0;
+    for (size_t j = 0; j < m; j++) {
+        for (size_t c = table[j].count; c > 0; c--) arr[k++] = table[j].key;
+    }
+    if (scratch_bytes) *scratch_bytes = sizeof(table);
+    return true;
+}
@@ -0,0 +1,35 @@
+#ifndef RADIX_SORT_H
+#define RADIX_SORT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Stable LSD radix sort, 8-bit digits, for every key type timsort.h instantiates.
+// temp must hold n elements. Signed and floating-point keys are mapped to unsigned
+// keys with an order-preserving bit transform while digits are extracted; the
+// stored values are never modified.
+//
+// Floats follow IEEE 754 totalOrder: -NaN < -inf < ... < -0.0 < +0.0 < ... < +inf < +NaN
+// (the sign bit decides where a NaN goes, so NaNs from 0.0/0.0, which are
+// negative on x86, sort first). timsort_f32/_f64 use the same order.
+void radix_sort_u32(uint32_t *arr, size_t n, uint32_t *temp);
+void radix_sort_u64(uint64_t *arr, size_t n, uint64_t *temp);
+void radix_sort_i32(int32_t *arr, size_t n, int32_t *temp);
+void radix_sort_i64(int64_t *arr, size_t n, int64_t *temp);
+void radix_sort_f32(float *arr, size_t n, float *temp);
+void radix_sort_f64(double *arr, size_t n, double *temp);
+
+// In-place MSD radix (American flag sort): counts one byte, swaps every key
+// straight into its bucket and recurses per bucket on the next byte. No temp;
+// buckets of 64 keys or fewer go to insertion sort, uniform buckets stop at once
+// and bytes shared by a whole bucket are skipped. Not stable.
+void radix_sort_msd_u32(uint32_t *arr, size_t n);
+
+// Counting sort for low-cardinality keys: one min/max pass, then either a direct
+// histogram (max - min < 65536) or a hash table of at most 256 distinct keys,
+// then a sequential fill. Returns false, with arr untouched, when the keys are
+// neither; *scratch_bytes (if not NULL) receives the table size used.
+bool counting_sort_u32(uint32_t *arr, size_t n, size_t *scratch_bytes);
+
+#endif
@@ -16,7 +16,7 @@ CFLAGS="-O3 -march=native -Wall"
 echo "=== Building benchmark ==="
 echo "Compiler: $CC"
 echo "Flags: $CFLAGS"
-$CC $CFLAGS -o sorting_benchmark sorting_benchmark.c -lm
+$CC $CFLAGS -o sorting_benchmark sorting_benchmark.c timsort.c simd_sort.c radix_sort.c sort_auto.c parallel_sort.c thread_pool.c stream_store.c sort_alloc.c -pthread -lm
 if [ $? -ne 0 ]; then
     echo "Compilation failed!"
     exit 1
@@ -34,6 +34,18 @@ for SIZE in 1000000 10000000 100000000 268435456; do
     ./sorting_benchmark $SIZE 3 >> "$OUTDIR/scaling_test.csv"
 done
 
+# =============================================================================
+# EXPERIMENT 1b: Huge-page sort buffers vs plain malloc
+# Purpose: page_faults and dtlb_misses columns with and without sort_alloc.c
+# =============================================================================
+echo ""
+echo "=== Experiment 1b: Huge Pages ==="
+
+for ALLOC in huge malloc; do
+    echo "Testing buffers: $ALLOC"
+    ./sorting_benchmark 67108864 3 $ALLOC > "$OUTDIR/alloc_$ALLOC.csv"
+done
+
 # =============================================================================
 # EXPERIMENT 2: Cache behavior analysis (using perf on Linux)
 # Purpose: Measure L1/L2/L3 cache misses for different RUN sizes
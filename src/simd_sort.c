@@ -0,0 +1,321 @@
+#include "simd_sort.h"
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SIMD_X86 1
+#include <immintrin.h>
+#else
+#define SIMD_X86 0
+#endif
+
+enum { ISA_SCALAR, ISA_AVX2, ISA_AVX512 };
+
+// ============================================================================
+// Scalar kernels (fallback and tails)
+// ============================================================================
+
+static void merge_scalar(const uint32_t *a, size_t na, const uint32_t *b, size_t nb, uint32_t *out) {
+    size_t i = 0, j = 0;
+    while (i < na && j < nb) {
+        uint32_t va = a[i], vb = b[j];
+        int take_a = va <= vb;
+        *out++ = take_a ? va : vb;
+        i += take_a;
+        j += !take_a;
+    }
+    while (i < na) *out++ = a[i++];
+    while (j < nb) *out++ = b[j++];
+}
+
+// finish a vector merge: reg[0..nr) is what is left in the register, a/b are the
+// stream remainders; everything already written is <= all three
+static void merge_tail3(const uint32_t *reg, size_t nr, const uint32_t *a, size_t na,
+                        const uint32_t *b, size_t nb, uint32_t *out) {
+    size_t r = 0, i = 0, j = 0;
+    while (r < nr) {
+        uint32_t v = reg[r];
+        if (i < na && a[i] < v && (j >= nb || a[i] <= b[j])) *out++ = a[i++];
+        else if (j < nb && b[j] < v) *out++ = b[j++];
+        else *out++ = reg[r++];
+    }
+    merge_scalar(a + i, na - i, b + j, nb - j, out);
+}
+
+// stable binary insertion sort: O(n log n) comparisons, one memmove per element
+static void binary_insertion_sort(uint32_t *arr, size_t n) {
+    for (size_t i = 1; i < n; i++) {
+        uint32_t v = arr[i];
+        size_t lo = 0, hi = i;
+        while (lo < hi) {
+            size_t m = lo + ((hi - lo) >> 1);
+            if (arr[m] <= v) lo = m + 1;
+            else hi = m;
+        }
+        memmove(arr + lo + 1, arr + lo, (i - lo) * sizeof(uint32_t));
+        arr[lo] = v;
+    }
+}
+
+#if SIMD_X86
+
+// ============================================================================
+// AVX2: 8 x uint32 per register
+// ============================================================================
+
+// one bitonic clean-up stage on both registers: compare lanes at distance d (via perm),
+// keep the min in lanes where mask bit is 0 and the max where it is 1
+#define AVX2_STAGE(lo, hi, perm_expr, blend_mask) do {                     \
+        __m256i tl = perm_expr(lo), th = perm_expr(hi);                     \
+        __m256i mnl = _mm256_min_epu32(lo, tl), mxl = _mm256_max_epu32(lo, tl); \
+        __m256i mnh = _mm256_min_epu32(hi, th), mxh = _mm256_max_epu32(hi, th); \
+        lo = _mm256_blend_epi32(mnl, mxl, blend_mask);                      \
+        hi = _mm256_blend_epi32(mnh, mxh, blend_mask);                      \
+    } while (0)
+
+#define AVX2_SWAP128(v)  _mm256_permute2x128_si256(v, v, 0x01)
+#define AVX2_SWAP64(v)   _mm256_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2))
+#define AVX2_SWAP32(v)   _mm256_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1))
+
+// *a and *b sorted ascending -> *a holds the 8 smallest, *b the 8 largest, both sorted
+__attribute__((target("avx2")))
+static inline void bitonic_merge_avx2(__m256i *a, __m256i *b) {
+    const __m256i rev = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+    __m256i rb = _mm256_permutevar8x32_epi32(*b, rev);
+    __m256i lo = _mm256_min_epu32(*a, rb);
+    __m256i hi = _mm256_max_epu32(*a, rb);
+
+    AVX2_STAGE(lo, hi, AVX2_SWAP128, 0xF0);
+    AVX2_STAGE(lo, hi, AVX2_SWAP64,  0xCC);
+    AVX2_STAGE(lo, hi, AVX2_SWAP32,  0xAA);
+
+    *a = lo;
+    *b = hi;
+}
+
+__attribute__((target("avx2")))
+static void merge_avx2(const uint32_t *a, size_t na, const uint32_t *b, size_t nb, uint32_t *out) {
+    if (na < 8 || nb < 8) {
+        merge_scalar(a, na, b, nb, out);
+        return;
+    }
+
+    __m256i vout = _mm256_loadu_si256((const __m256i *)a);
+    __m256i vkeep = _mm256_loadu_si256((const __m256i *)b);
+    size_t i = 8, j = 8;
+
+    for (;;) {
+        bitonic_merge_avx2(&vout, &vkeep);
+        _mm256_storeu_si256((__m256i *)out, vout);
+        out += 8;
+
+        // next block comes from the stream with the smaller head
+        if (i < na && (j >= nb || a[i] <= b[j])) {
+            if (i + 8 > na) break;
+            vout = _mm256_loadu_si256((const __m256i *)(a + i));
+            i += 8;
+        } else {
+            if (j + 8 > nb) break;
+            vout = _mm256_loadu_si256((const __m256i *)(b + j));
+            j += 8;
+        }
+    }
+
+    uint32_t reg[8];
+    _mm256_storeu_si256((__m256i *)reg, vkeep);
+    merge_tail3(reg, 8, a + i, na - i, b + j, nb - j, out);
+}
+
+// one bitonic sorting-network stage on a single register: lanes i and i^j are compared,
+// lanes whose bit is set in blend_mask keep the max
+#define AVX2_SORT_STAGE(v, i0, i1, i2, i3, i4, i5, i6, i7, blend_mask) do {        \
+        __m256i t = _mm256_permutevar8x32_epi32(v,                                   \
+                        _mm256_setr_epi32(i0, i1, i2, i3, i4, i5, i6, i7));          \
+        v = _mm256_blend_epi32(_mm256_min_epu32(v, t), _mm256_max_epu32(v, t), blend_mask); \
+    } while (0)
+
+// sort the 8 lanes of v ascending (bitonic sorting network, 6 stages)
+__attribute__((target("avx2")))
+static inline __m256i bitonic_sort_avx2(__m256i v) {
+    AVX2_SORT_STAGE(v, 1, 0, 3, 2, 5, 4, 7, 6, 0x66);   // k=2 j=1
+    AVX2_SORT_STAGE(v, 2, 3, 0, 1, 6, 7, 4, 5, 0x3C);   // k=4 j=2
+    AVX2_SORT_STAGE(v, 1, 0, 3, 2, 5, 4, 7, 6, 0x5A);   // k=4 j=1
+    AVX2_SORT_STAGE(v, 4, 5, 6, 7, 0, 1, 2, 3, 0xF0);   // k=8 j=4
+    AVX2_SORT_STAGE(v, 2, 3, 0, 1, 6, 7, 4, 5, 0xCC);   // k=8 j=2
+    AVX2_SORT_STAGE(v, 1, 0, 3, 2, 5, 4, 7, 6, 0xAA);   // k=8 j=1
+    return v;
+}
+
+// sort every full 8-key block in registers; a short tail uses binary insertion
+__attribute__((target("avx2")))
+static void sort_blocks_avx2(uint32_t *arr, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(arr + i));
+        _mm256_storeu_si256((__m256i *)(arr + i), bitonic_sort_avx2(v));
+    }
+    binary_insertion_sort(arr + i, n - i);
+}
+
+// ============================================================================
+// AVX-512: 16 x uint32 per register
+// ============================================================================
+
+__attribute__((target("avx512f")))
+static inline void bitonic_merge_avx512(__m512i *a, __m512i *b) {
+    const __m512i rev = _mm512_setr_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+    const __m512i x8  = _mm512_setr_epi32(8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7);
+    const __m512i x4  = _mm512_setr_epi32(4, 5, 6, 7, 0, 1, 2, 3, 12, 13, 14, 15, 8, 9, 10, 11);
+    const __m512i x2  = _mm512_setr_epi32(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13);
+    const __m512i x1  = _mm512_setr_epi32(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+    const __m512i idx[4]  = { x8, x4, x2, x1 };
+    const __mmask16 hi_lanes[4] = { 0xFF00, 0xF0F0, 0xCCCC, 0xAAAA };
+
+    __m512i rb = _mm512_permutexvar_epi32(rev, *b);
+    __m512i lo = _mm512_min_epu32(*a, rb);
+    __m512i hi = _mm512_max_epu32(*a, rb);
+
+    for (int s = 0; s < 4; s++) {
+        __m512i tl = _mm512_permutexvar_epi32(idx[s], lo);
+        __m512i th = _mm512_permutexvar_epi32(idx[s], hi);
+        lo = _mm512_mask_max_epu32(_mm512_min_epu32(lo, tl), hi_lanes[s], lo, tl);
+        hi = _mm512_mask_max_epu32(_mm512_min_epu32(hi, th), hi_lanes[s], hi, th);
+    }
+
+    *a = lo;
+    *b = hi;
+}
+
+__attribute__((target("avx512f")))
+static void merge_avx512(const uint32_t *a, size_t na, const uint32_t *b, size_t nb, uint32_t *out) {
+    if (na < 16 || nb < 16) {
+        merge_scalar(a, na, b, nb, out);
+        return;
+    }
+
+    __m512i vout = _mm512_loadu_si512(a);
+    __m512i vkeep = _mm512_loadu_si512(b);
+    size_t i = 16, j = 16;
+
+    for (;;) {
+        bitonic_merge_avx512(&vout, &vkeep);
+        _mm512_storeu_si512(out, vout);
+        out += 16;
+
+        if (i < na && (j >= nb || a[i] <= b[j])) {
+            if (i + 16 > na) break;
+            vout = _mm512_loadu_si512(a + i);
+            i += 16;
+        } else {
+            if (j + 16 > nb) break;
+            vout = _mm512_loadu_si512(b + j);
+            j += 16;
+        }
+    }
+
+    uint32_t reg[16];
+    _mm512_storeu_si512(reg, vkeep);
+    merge_tail3(reg, 16, a + i, na - i, b + j, nb - j, out);
+}
+
+// sort the 16 lanes of v ascending (bitonic sorting network, 10 stages)
+__attribute__((target("avx512f")))
+static inline __m512i bitonic_sort_avx512(__m512i v) {
+    const __m512i x8 = _mm512_setr_epi32(8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7);
+    const __m512i x4 = _mm512_setr_epi32(4, 5, 6, 7, 0, 1, 2, 3, 12, 13, 14, 15, 8, 9, 10, 11);
+    const __m512i x2 = _mm512_setr_epi32(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13);
+    const __m512i x1 = _mm512_setr_epi32(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+    // (k, j) = (2,1) (4,2) (4,1) (8,4) (8,2) (8,1) (16,8) (16,4) (16,2) (16,1)
+    const __m512i idx[10] = { x1, x2, x1, x4, x2, x1, x8, x4, x2, x1 };
+    const __mmask16 max_lanes[10] = { 0x6666, 0x3C3C, 0x5A5A, 0x0FF0, 0x33CC,
+                                      0x55AA, 0xFF00, 0xF0F0, 0xCCCC, 0xAAAA };
+
+    for (int s = 0; s < 10; s++) {
+        __m512i t = _mm512_permutexvar_epi32(idx[s], v);
+        v = _mm512_mask_max_epu32(_mm512_min_epu32(v, t), max_lanes[s], v, t);
+    }
+    return v;
+}
+
+// sort every 16-key block in registers; the tail is padded with UINT32_MAX, which
+// sorts to the end and is never stored
+__attribute__((target("avx512f")))
+static void sort_blocks_avx512(uint32_t *arr, size_t n) {
+    for (size_t i = 0; i < n; i += 16) {
+        size_t len = (n - i < 16) ? n - i : 16;
+        __mmask16 m = (__mmask16)((1u << len) - 1);
+        __m512i v = _mm512_mask_loadu_epi32(_mm512_set1_epi32(-1), m, arr + i);
+        _mm512_mask_storeu_epi32(arr + i, m, bitonic_sort_avx512(v));
+    }
+}
+
+#endif // SIMD_X86
+
+// ============================================================================
+// Runtime dispatch
+// ============================================================================
+
+static int detect_isa(void) {
+    static int isa = -1;
+    if (isa < 0) {
+#if SIMD_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) isa = ISA_AVX512;
+        else if (__builtin_cpu_supports("avx2")) isa = ISA_AVX2;
+        else isa = ISA_SCALAR;
+#else
+        isa = ISA_SCALAR;
+#endif
+    }
+    return isa;
+}
+
+const char *simd_isa(void) {
+    switch (detect_isa()) {
+        case ISA_AVX512: return "avx512";
+        case ISA_AVX2:   return "avx2";
+        default:         return "scalar";
+    }
+}
+
+void simd_sort_run_u32(uint32_t *arr, size_t n, uint32_t *scratch) {
+    if (n <= 1) return;
+
+    size_t block;
+    switch (detect_isa()) {
+#if SIMD_X86
+        case ISA_AVX512: sort_blocks_avx512(arr, n); block = 16; break;
+        case ISA_AVX2:   sort_blocks_avx2(arr, n);   block = 8;  break;
+#endif
+        default:
+            binary_insertion_sort(arr, n);
+            return;
+    }
+
+    // merge the sorted blocks up to n, alternating between arr and scratch
+    uint32_t *src = arr, *dst = scratch;
+    for (size_t width = block; width < n; width *= 2) {
+        for (size_t left = 0; left < n; left += 2 * width) {
+            size_t mid = left + width;
+            if (mid >= n) {
+                memcpy(dst + left, src + left, (n - left) * sizeof(uint32_t));
+                break;
+            }
+            size_t right = (left + 2 * width < n) ? left + 2 * width : n;
+            simd_merge_u32(src + left, mid - left, src + mid, right - mid, dst + left);
+        }
+        uint32_t *swap = src;
+        src = dst;
+        dst = swap;
+    }
+    if (src != arr) memcpy(arr, src, n * sizeof(uint32_t));
+}
+
+void simd_merge_u32(const uint32_t *a, size_t na, const uint32_t *b, size_t nb, uint32_t *out) {
+    switch (detect_isa()) {
+#if SIMD_X86
+        case ISA_AVX512: merge_avx512(a, na, b, nb, out); break;
+        case ISA_AVX2:   merge_avx2(a, na, b, nb, out); break;
+#endif
+        default:         merge_scalar(a, na, b, nb, out); break;
+    }
+}
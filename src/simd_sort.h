@@ -0,0 +1,20 @@
+#ifndef SIMD_SORT_H
+#define SIMD_SORT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Merge sorted a[0..na) and b[0..nb) into out[0..na+nb) (out must not alias a or b).
+// Uses a bitonic merge network on 16 (AVX-512) or 8 (AVX2) keys per step, chosen once
+// from CPUID at run time, and a scalar merge on other hosts.
+void simd_merge_u32(const uint32_t *a, size_t na, const uint32_t *b, size_t nb, uint32_t *out);
+
+// Sort a short run arr[0..n) (typically one RUN block): 16- or 8-key blocks are sorted in
+// registers with a bitonic sorting network, then merged up to n with simd_merge_u32.
+// Hosts without AVX2 use binary insertion sort. scratch must hold n elements.
+void simd_sort_run_u32(uint32_t *arr, size_t n, uint32_t *scratch);
+
+// Kernel picked for this host: "avx512", "avx2" or "scalar"
+const char *simd_isa(void);
+
+#endif
@@ -0,0 +1,86 @@
+#include "sort_alloc.h"
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+size_t sort_buf_huge_min = SORT_BUF_HUGE_MIN;
+
+// Kept in the bytes just below every buffer: how to release it
+typedef struct {
+    void *base;     // start of the mapping or of the malloc() block
+    size_t len;     // mapping length; 0 for malloc()
+} buf_hdr_t;
+
+#define HDR 16      // keeps malloc()'s 16-byte alignment
+
+static buf_hdr_t *header(void *p) {
+    return (buf_hdr_t *)((char *)p - HDR);
+}
+
+static void touch(char *p, size_t bytes) {
+    for (size_t off = 0; off < bytes; off += 4096) p[off] = 0;
+}
+
+#ifdef MAP_ANONYMOUS
+// Map whole huge pages at a 2 MB boundary with one small page below for the
+// header; NULL if the kernel refuses
+static void *map_huge(size_t bytes, bool prefault) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t len = (bytes + SORT_BUF_HUGE_PAGE - 1) & ~(SORT_BUF_HUGE_PAGE - 1);
+    size_t span = len + SORT_BUF_HUGE_PAGE;     // room to slide up to the boundary
+    char *base = (char *)mmap(NULL, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) return NULL;
+
+    uintptr_t at = ((uintptr_t)base + page + SORT_BUF_HUGE_PAGE - 1) & ~(uintptr_t)(SORT_BUF_HUGE_PAGE - 1);
+    char *p = (char *)at;
+    char *lo = p - page, *end = base + span;
+    if (lo > base) munmap(base, (size_t)(lo - base));
+    if (p + len < end) munmap(p + len, (size_t)(end - (p + len)));
+#ifdef MADV_HUGEPAGE
+    madvise(p, len, MADV_HUGEPAGE);
+#endif
+    if (prefault) {
+#ifdef MADV_POPULATE_WRITE
+        if (madvise(p, len, MADV_POPULATE_WRITE) != 0)     // Linux < 5.14: EINVAL
+#endif
+            touch(p, len);
+    }
+    *header(p) = (buf_hdr_t){lo, len + page};
+    return p;
+}
+#endif
+
+void *sort_buf_alloc(size_t bytes, bool prefault) {
+    if (bytes > SIZE_MAX - 2 * SORT_BUF_HUGE_PAGE) {
+        errno = ENOMEM;
+        return NULL;
+    }
+#ifdef MAP_ANONYMOUS
+    if (bytes >= sort_buf_huge_min) {
+        void *p = map_huge(bytes, prefault);
+        if (p) return p;
+    }
+#endif
+    char *b = (char *)malloc(bytes + HDR);
+    if (!b) return NULL;
+    char *p = b + HDR;
+    *header(p) = (buf_hdr_t){b, 0};
+    if (prefault) touch(p, bytes);
+    return p;
+}
+
+void sort_buf_free(void *p) {
+    if (!p) return;
+    buf_hdr_t h = *header(p);
+#ifdef MAP_ANONYMOUS
+    if (h.len) {
+        munmap(h.base, h.len);
+        return;
+    }
+#endif
+    free(h.base);
+}
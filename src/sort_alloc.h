@@ -0,0 +1,30 @@
+#ifndef SORT_ALLOC_H
+#define SORT_ALLOC_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Scratch buffers for the sorts. From sort_buf_huge_min bytes up a buffer is an
+// anonymous mapping aligned to 2 MB and marked MADV_HUGEPAGE, so the kernel can
+// back it with transparent huge pages: a 1 GB radix scatter target then needs 512
+// TLB entries instead of 262144, and faults in 2 MB at a time. Smaller buffers,
+// hosts without mmap() and refused mappings fall back to malloc().
+
+#ifndef SORT_BUF_HUGE_MIN
+#define SORT_BUF_HUGE_MIN ((size_t)4 << 20)   // two huge pages
+#endif
+#define SORT_BUF_HUGE_PAGE ((size_t)2 << 20)
+
+// Buffers of at least this many bytes are huge-page mappings. SIZE_MAX disables
+// them; not thread-safe to change while sorts are running.
+extern size_t sort_buf_huge_min;
+
+// bytes of scratch, 16-byte aligned (2 MB for mappings). With prefault every page
+// is faulted in before returning, so a timed sort that follows takes no page
+// faults on it. NULL (errno ENOMEM) on failure.
+void *sort_buf_alloc(size_t bytes, bool prefault);
+
+// p from sort_buf_alloc(), or NULL
+void sort_buf_free(void *p);
+
+#endif
@@ -0,0 +1,104 @@
+#include "sort_auto.h"
+#include "radix_sort.h"
+#include "parallel_sort.h"
+#include "thread_pool.h"
+#include "sort_alloc.h"
+
+_Static_assert((T)-1 > 0 && sizeof(T) == sizeof(uint32_t), "sort_auto dispatches uint32 radix kernels");
+
+#define AUTO_SMALL    4096        // below this, timsort without looking
+#define AUTO_PARALLEL (1 << 22)   // from here on, use every core when there are several
+#define AUTO_BLOCKS   32          // contiguous blocks checked for descents ...
+#define AUTO_BLOCK    32          // ... of this many elements each
+#define AUTO_SAMPLE   1024        // strided keys checked for distinct values and range
+#define AUTO_FEW_DISTINCT 192     // counting sort below this (it gives up past 256 keys)
+#define AUTO_HOT_SHARE 16         // a key in 1/16 of the sample would swamp a samplesort bucket
+
+sort_plan_t sort_auto_plan(const T *arr, size_t n) {
+    sort_plan_t plan = {SORT_TIMSORT, 0, 0, 0, 0, 0, 0};
+    if (n < AUTO_SMALL) return plan;
+
+    // Runs: how often adjacent keys descend inside evenly spaced blocks
+    size_t step = n / AUTO_BLOCKS;
+    for (size_t b = 0; b < AUTO_BLOCKS; b++) {
+        const T *p = arr + b * step;
+        for (size_t i = 1; i < AUTO_BLOCK; i++) {
+            plan.descents += !cmp(p[i - 1], p[i]);
+        }
+        plan.pairs += AUTO_BLOCK - 1;
+    }
+
+    // Distinct values and used bits from a sorted strided sample
+    T sample[AUTO_SAMPLE];
+    plan.sample = AUTO_SAMPLE;
+    for (size_t i = 0; i < AUTO_SAMPLE; i++) {
+        sample[i] = arr[(n / AUTO_SAMPLE) * i];
+    }
+    timsort_mode(sample, AUTO_SAMPLE, TIMSORT_INPLACE);
+    plan.distinct = 1;
+    plan.top = 1;
+    for (size_t i = 1, same = 1; i < AUTO_SAMPLE; i++) {
+        same = sample[i] == sample[i - 1] ? same + 1 : 1;
+        plan.distinct += same == 1;
+        if (same > plan.top) plan.top = same;
+    }
+    T span = sample[AUTO_SAMPLE - 1] - sample[0];
+    plan.key_bits = span ? 32 - (unsigned)__builtin_clz(span) : 0;
+
+    // Long natural runs either way: timsort finishes in a few linear passes
+    if (plan.descents * 16 <= plan.pairs || plan.descents * 16 >= plan.pairs * 15) {
+        plan.alg = SORT_TIMSORT;
+    } else if (plan.distinct <= AUTO_FEW_DISTINCT || plan.key_bits <= 16) {
+        plan.alg = SORT_COUNTING;       // one counting pass and a fill
+    } else if (plan.distinct * 2 <= plan.sample || plan.top * AUTO_HOT_SHARE >= plan.sample) {
+        // Before the samplesort: equal keys share one of its buckets, which is then
+        // sorted by a single thread
+        plan.alg = SORT_RADIX_MSD;      // buckets go uniform after a level or two
+    } else if (n >= AUTO_PARALLEL && tpool_default() && tpool_size(tpool_default()) > 1) {
+        plan.alg = SORT_PARALLEL;
+    } else {
+        plan.alg = SORT_RADIX_LSD;      // trivial digits are skipped anyway
+    }
+    return plan;
+}
+
+sort_plan_t sort_auto(T *arr, size_t n) {
+    sort_plan_t plan = sort_auto_plan(arr, n);
+    switch (plan.alg) {
+        case SORT_TIMSORT:
+            timsort(arr, n);
+            break;
+        case SORT_PARALLEL:
+            sort_parallel(arr, n, 0);
+            break;
+        case SORT_COUNTING:
+            if (counting_sort_u32(arr, n, NULL)) break;
+            plan.alg = SORT_RADIX_LSD;  // the sample missed keys: too many for counting
+            // fall through
+        case SORT_RADIX_LSD: {
+            T *temp = (T *)sort_buf_alloc(n * sizeof(T), false);
+            if (temp) {
+                radix_sort_u32(arr, n, temp);
+                sort_buf_free(temp);
+                break;
+            }
+            plan.alg = SORT_RADIX_MSD;  // no scratch: sort in place instead
+        }
+        // fall through
+        case SORT_RADIX_MSD:
+            radix_sort_msd_u32(arr, n);
+            break;
+    }
+    return plan;
+}
+
+const char *sort_alg_name(sort_alg_t alg) {
+    switch (alg) {
+        case SORT_TIMSORT:   return "timsort";
+        case SORT_RADIX_LSD: return "radix_lsd";
+        case SORT_RADIX_MSD: return "radix_msd";
+        case SORT_COUNTING:  return "counting";
+        case SORT_PARALLEL:  return "parallel";
+        default:             return "unknown";
+    }
+}
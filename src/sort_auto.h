@@ -0,0 +1,34 @@
+#ifndef SORT_AUTO_H
+#define SORT_AUTO_H
+
+#include "timsort.h"
+
+// Algorithms sort_auto() can pick
+typedef enum {
+    SORT_TIMSORT,       // presorted or small input: natural runs make it near-linear
+    SORT_RADIX_LSD,     // full-entropy keys
+    SORT_RADIX_MSD,     // many duplicates spread over many bits; no scratch
+    SORT_COUNTING,      // tiny key range or a handful of distinct keys
+    SORT_PARALLEL       // large input on a multi-core host: samplesort on the worker pool
+} sort_alg_t;
+
+// What the sample showed and what was chosen
+typedef struct {
+    sort_alg_t alg;
+    size_t pairs;       // adjacent pairs inspected in the sampled blocks
+    size_t descents;    // ... of which were out of order
+    size_t sample;      // strided keys inspected for distinct values and range
+    size_t distinct;    // distinct keys among them
+    size_t top;         // occurrences of the most common one
+    unsigned key_bits;  // bits needed for max - min of the sampled keys
+} sort_plan_t;
+
+// Inspect about 2K elements of arr and choose an algorithm; arr is not modified
+sort_plan_t sort_auto_plan(const T *arr, size_t n);
+
+// Sort arr with the algorithm sort_auto_plan() picks; returns the plan
+sort_plan_t sort_auto(T *arr, size_t n);
+
+const char *sort_alg_name(sort_alg_t alg);
+
+#endif
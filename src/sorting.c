@@ -1,12 +1,20 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
 #include <time.h>
 #include "timsort.h"  // provides T and cmp
+#include "sort_alloc.h"
 
 // RUN size
 #define RUN 64
 
+// 1: merge by copying only the smaller run out (temp of size/2 elements)
+// 0: ping-pong merge between arr and a full-size temp (less memory traffic)
+#ifndef SORT_HALF_BUFFER
+#define SORT_HALF_BUFFER 0
+#endif
+
 // insertion_sort in range of [left, right] 
 static void insertion_sort(T *arr, size_t left, size_t right) {
     for (size_t i = left + 1; i <= right; i++) {
@@ -20,30 +28,70 @@ static void insertion_sort(T *arr, size_t left, size_t right) {
     }
 }
 
-// merge [left, mid] and [mid+1, right]
-static void merge(T *arr, size_t left, size_t mid, size_t right, T *temp) {
+#if !SORT_HALF_BUFFER
+// merge [left, mid] and [mid+1, right] of src into the same range of dst
+static void merge(const T *src, size_t left, size_t mid, size_t right, T *dst) {
     size_t i = left;
     size_t j = mid + 1;
     size_t k = left;
 
     while (i <= mid && j <= right) {
-        if (cmp(arr[i], arr[j])) {
-            temp[k++] = arr[i++];
+        if (cmp(src[i], src[j])) {
+            dst[k++] = src[i++];
         } else {
-            temp[k++] = arr[j++];
+            dst[k++] = src[j++];
         }
     }
     while (i <= mid) {
-        temp[k++] = arr[i++];
+        dst[k++] = src[i++];
     }
     while (j <= right) {
-        temp[k++] = arr[j++];
+        dst[k++] = src[j++];
     }
+}
+#endif
+
+#if SORT_HALF_BUFFER
+// merge [left, mid] and [mid+1, right] back into arr, copying only the smaller run to temp
+static void merge_half(T *arr, size_t left, size_t mid, size_t right, T *temp) {
+    size_t n1 = mid - left + 1;
+    size_t n2 = right - mid;
 
-    for (size_t idx = left; idx <= right; idx++) {
-        arr[idx] = temp[idx];
+    if (n1 <= n2) {
+        // left run out, merge forward
+        memcpy(temp, arr + left, n1 * sizeof(T));
+        size_t i = 0;
+        size_t j = mid + 1;
+        size_t k = left;
+        while (i < n1 && j <= right) {
+            if (cmp(temp[i], arr[j])) {
+                arr[k++] = temp[i++];
+            } else {
+                arr[k++] = arr[j++];
+            }
+        }
+        while (i < n1) {
+            arr[k++] = temp[i++];
+        }
+    } else {
+        // right run out, merge backward
+        memcpy(temp, arr + mid + 1, n2 * sizeof(T));
+        size_t i = mid + 1;
+        size_t j = n2;
+        size_t k = right + 1;
+        while (i > left && j > 0) {
+            if (cmp(arr[i - 1], temp[j - 1])) {
+                arr[--k] = temp[--j];
+            } else {
+                arr[--k] = arr[--i];
+            }
+        }
+        while (j > 0) {
+            arr[--k] = temp[--j];
+        }
     }
 }
+#endif
 
 // Avoid making changes to this function skeleton, apart from data type changes if required
 // In this starter code we have used uint32_t, feel free to change it to any other data type if required
@@ -52,9 +100,11 @@ void sort_array(T *arr, size_t size) {
     if (size <= 1 || arr == NULL) return;
 
     // create temp cache
-    T *temp = (T *)malloc(size * sizeof(T));
+    size_t temp_size = SORT_HALF_BUFFER ? size / 2 : size;
+    T *temp = (T *)sort_buf_alloc(temp_size * sizeof(T), false);
     if (!temp) {
-        fprintf(stderr, "Error: failed to allocate temp buffer for sorting.\n");
+        // no room for scratch: stable merge with a fixed stack buffer instead
+        timsort_mode(arr, size, TIMSORT_INPLACE);
         return;
     }
 
@@ -67,7 +117,8 @@ void sort_array(T *arr, size_t size) {
         insertion_sort(arr, i, right);
     }
 
-    // Step 2: merge
+#if SORT_HALF_BUFFER
+    // Step 2: merge in place, the smaller run of each pair goes through temp
     for (size_t curr_size = RUN; curr_size < size; curr_size *= 2) {
         for (size_t left = 0; left < size; left += 2 * curr_size) {
             size_t mid = left + curr_size - 1;
@@ -78,11 +129,40 @@ void sort_array(T *arr, size_t size) {
             if (right >= size) {
                 right = size - 1;
             }
-            merge(arr, left, mid, right, temp);
+            merge_half(arr, left, mid, right, temp);
         }
     }
+#else
+    // Step 2: merge, alternating source and destination between arr and temp
+    // on each level instead of copying every merged range back
+    T *src = arr;
+    T *dst = temp;
+    for (size_t curr_size = RUN; curr_size < size; curr_size *= 2) {
+        for (size_t left = 0; left < size; left += 2 * curr_size) {
+            size_t mid = left + curr_size - 1;
+            if (mid >= size - 1) {
+                // unpaired tail still has to move to this level's destination
+                memcpy(dst + left, src + left, (size - left) * sizeof(T));
+                break;
+            }
+            size_t right = left + 2 * curr_size - 1;
+            if (right >= size) {
+                right = size - 1;
+            }
+            merge(src, left, mid, right, dst);
+        }
+        T *swap = src;
+        src = dst;
+        dst = swap;
+    }
+
+    // odd number of levels: the result is in temp
+    if (src != arr) {
+        memcpy(arr, src, size * sizeof(T));
+    }
+#endif
 
-    free(temp);
+    sort_buf_free(temp);
 }
 
 // (Standalone main removed; sorting.c now provides library functions only)
@@ -6,7 +6,17 @@
 #include <sys/time.h>
 #ifdef __linux__
 #include <sys/resource.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <linux/perf_event.h>
 #endif
+#include "timsort.h"   // T, cmp and the adaptive library timsort()
+#include "simd_sort.h" // vectorized uint32 merge kernels
+#include "radix_sort.h" // radix sorts for signed and floating-point keys
+#include "sort_auto.h"  // sampling dispatcher
+#include "stream_store.h" // non-temporal stores for outputs larger than the LLC
+#include "sort_alloc.h"   // huge-page scratch buffers
 
 /* ================= METRICS STRUCT ================= */
 
@@ -14,6 +24,11 @@ typedef struct {
     double elapsed_sec;   // wall-clock runtime
     long max_rss_kb;      // peak resident memory
     uint64_t cpu_cycles;  // filled via perf if needed (placeholder)
+    uint64_t comparisons; // cmp_le calls made by the timed run
+    size_t scratch_bytes; // peak scratch used by the timed run
+    size_t traffic_bytes; // bytes read + written by the timed run's passes (0: unknown)
+    long page_faults;     // minor + major faults taken by the timed run
+    long long dtlb_misses; // dTLB load + store misses of the timed run (-1: no counter)
 } metrics_t;
 
 /* Wall-clock time (seconds) */
@@ -36,13 +51,70 @@ static inline long get_max_rss_kb(void) {
 }
     
 
+/* Page faults so far (minor + major) */
+static inline long get_page_faults(void) {
+    #ifdef __linux__
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_minflt + usage.ru_majflt;
+    #else
+        return 0;
+#endif
+}
+
+/* dTLB load and store miss counters (user space, inherited by the worker threads);
+   -1 where perf_event_open is unavailable or the CPU has no such event */
+static int tlb_fd[2] = {-1, -1};
+
+static void tlb_counters_open(void) {
+#ifdef __linux__
+    static const unsigned long long ops[2] = {
+        PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_OP_WRITE
+    };
+    for (int i = 0; i < 2; i++) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_DTLB | (ops[i] << 8) |
+                      ((unsigned long long)PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        attr.disabled = 1;
+        attr.inherit = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        tlb_fd[i] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+#endif
+}
+
+static long fault_base;
+
 /* Metrics helpers */
 static inline void metrics_begin(double *t0) {
+#ifdef __linux__
+    for (int i = 0; i < 2; i++) {
+        if (tlb_fd[i] < 0) continue;
+        ioctl(tlb_fd[i], PERF_EVENT_IOC_RESET, 0);
+        ioctl(tlb_fd[i], PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+    fault_base = get_page_faults();
     *t0 = now_sec();
 }
 
 static inline void metrics_end(metrics_t *m, double t0) {
     m->elapsed_sec = now_sec() - t0;
+    m->page_faults = get_page_faults() - fault_base;
+    m->dtlb_misses = -1;
+#ifdef __linux__
+    for (int i = 0; i < 2; i++) {
+        long long count;
+        if (tlb_fd[i] < 0) continue;
+        ioctl(tlb_fd[i], PERF_EVENT_IOC_DISABLE, 0);
+        if (read(tlb_fd[i], &count, sizeof(count)) != (ssize_t)sizeof(count)) continue;
+        m->dtlb_misses = (m->dtlb_misses < 0 ? 0 : m->dtlb_misses) + count;
+    }
+#endif
     m->max_rss_kb = get_max_rss_kb();
     m->cpu_cycles = 0;   // populated externally via perf
 }
@@ -51,7 +123,7 @@ static inline void metrics_end(metrics_t *m, double t0) {
 // CONFIGURATION - Adjust these for experiments
 // ============================================================================
 
-typedef uint32_t T;  // Data type: uint32_t or float
+// Data type T (uint32_t or float) is configured in timsort.h
 
 // RUN sizes to test (tune based on L1 cache size)
 // EPYC 9354P: 32KB L1d per core -> ~8192 uint32_t
@@ -63,6 +135,9 @@ typedef uint32_t T;  // Data type: uint32_t or float
 #define RUN_XLARGE  256
 #define RUN_CACHE   512  // For cache-line aligned experiments
 
+// Instance price for the cost_per_GB column ($/hour, CloudLab-style example)
+#define HOURLY_COST 0.50
+
 // ============================================================================
 // UTILITY FUNCTIONS
 // ============================================================================
@@ -74,8 +149,44 @@ static inline double get_time_us(void) {
     return tv.tv_sec * 1e6 + tv.tv_usec;
 }
 
+// Comparisons made through cmp_le; reset and read around each timed run. The
+// counter puts a read-modify-write on every comparison, so it is compiled in only
+// with -DBENCH_COUNT_CMP=1 (make sorting_benchmark_cmp), a build whose timings are
+// not comparable; otherwise the comparisons column is -1
+#ifndef BENCH_COUNT_CMP
+#define BENCH_COUNT_CMP 0
+#endif
+static uint64_t cmp_count;
+
+// Peak scratch bytes of the timed run. Defaults to the caller's n-element temp;
+// wrappers that need less (or allocate their own) overwrite it.
+static size_t scratch_bytes;
+
+// Bytes the timed run moved through memory (each pass over the data counts its
+// reads and writes), for the bandwidth_GB_s column; 0 (printed as -1) when the
+// wrapper does not model it
+static size_t traffic_bytes;
+
+// Benchmark buffers (source, work, temp) come from sort_buf_alloc(); with the
+// huge-page layer on they are also pre-faulted, so no timed run faults them in
+static bool buf_prefault = true;
+
+// Traffic of a ping-pong merge sort over runs of `run` elements: run formation and
+// every merge level read and write the array once
+static size_t merge_traffic(size_t size, size_t run) {
+    size_t levels = 1;
+    for (size_t r = run; r < size; r *= 2) levels++;
+    return 2 * levels * size * sizeof(T);
+}
+
+// Decision a dispatching wrapper made in the timed run; printed as name[detail]
+static const char *row_detail;
+
 // Compare function for stability
 static inline int cmp_le(T a, T b) {
+#if BENCH_COUNT_CMP
+    cmp_count++;
+#endif
     return a <= b;
 }
 
@@ -210,6 +321,52 @@ static void timsort_with_run(T *arr, size_t size, size_t run_size, T *temp) {
     }
 }
 
+// ============================================================================
+// OPTIMIZATION 1b: BRANCHLESS MERGE
+// On random data the "which run wins" branch mispredicts about half the time.
+// Load both heads, select the output with a conditional move and advance both
+// pointers by the comparison result, so the only branch left is the loop
+// bound. Valid for arithmetic T (the select is a register move).
+// ============================================================================
+
+static void merge_branchless(T *arr, size_t left, size_t mid, size_t right, T *temp) {
+    const T *pa = &arr[left], *end_a = &arr[mid + 1];
+    const T *pb = &arr[mid + 1], *end_b = &arr[right + 1];
+    T *out = &temp[left];
+
+    while (pa < end_a && pb < end_b) {
+        T va = *pa, vb = *pb;
+        int take_a = cmp_le(va, vb);
+        *out++ = take_a ? va : vb;
+        pa += take_a;
+        pb += !take_a;
+    }
+    memcpy(out, pa, (size_t)(end_a - pa) * sizeof(T));
+    out += end_a - pa;
+    memcpy(out, pb, (size_t)(end_b - pb) * sizeof(T));
+
+    memcpy(&arr[left], &temp[left], (right - left + 1) * sizeof(T));
+}
+
+static void timsort_branchless(T *arr, size_t size, size_t run_size, T *temp) {
+    if (size <= 1) return;
+
+    for (size_t i = 0; i < size; i += run_size) {
+        size_t right = (i + run_size - 1 < size - 1) ? i + run_size - 1 : size - 1;
+        insertion_sort_range(arr, i, right);
+    }
+
+    for (size_t curr_size = run_size; curr_size < size; curr_size *= 2) {
+        for (size_t left = 0; left < size; left += 2 * curr_size) {
+            size_t mid = left + curr_size - 1;
+            if (mid >= size - 1) break;
+            size_t right = (left + 2 * curr_size - 1 < size - 1) ?
+                           left + 2 * curr_size - 1 : size - 1;
+            merge_branchless(arr, left, mid, right, temp);
+        }
+    }
+}
+
 // ============================================================================
 // OPTIMIZATION 2: CACHE-OPTIMIZED MERGE WITH PREFETCHING
 // Prefetch data into cache before it's needed
@@ -263,6 +420,240 @@ static void timsort_prefetch(T *arr, size_t size, size_t run_size, T *temp) {
     }
 }
 
+// ============================================================================
+// OPTIMIZATION 2b: GALLOPING MERGE
+// Once one run wins MIN_GALLOP comparisons in a row, switch to exponential
+// search for the end of the streak and copy it with one memcpy. min_gallop
+// adapts across merges: it drops while galloping pays off and rises when it
+// does not, so random data stays in the one-at-a-time loop.
+// ============================================================================
+
+#define MIN_GALLOP 7
+
+// number of leading elements of a[0..n) that are <= key
+static size_t gallop_right(T key, const T *a, size_t n) {
+    if (n == 0 || !cmp_le(a[0], key)) return 0;
+    size_t last = 0, ofs = 1;
+    while (ofs < n && cmp_le(a[ofs], key)) {
+        last = ofs;
+        ofs = (ofs << 1) + 1;
+    }
+    if (ofs > n) ofs = n;
+    last++;
+    while (last < ofs) {
+        size_t m = last + ((ofs - last) >> 1);
+        if (cmp_le(a[m], key)) last = m + 1;
+        else ofs = m;
+    }
+    return ofs;
+}
+
+// number of leading elements of a[0..n) that are < key
+static size_t gallop_left(T key, const T *a, size_t n) {
+    if (n == 0 || cmp_le(key, a[0])) return 0;
+    size_t last = 0, ofs = 1;
+    while (ofs < n && !cmp_le(key, a[ofs])) {
+        last = ofs;
+        ofs = (ofs << 1) + 1;
+    }
+    if (ofs > n) ofs = n;
+    last++;
+    while (last < ofs) {
+        size_t m = last + ((ofs - last) >> 1);
+        if (!cmp_le(key, a[m])) last = m + 1;
+        else ofs = m;
+    }
+    return ofs;
+}
+
+static void merge_prefetch_gallop(T *arr, size_t left, size_t mid, size_t right,
+                                  T *temp, size_t *min_gallop_state) {
+    // Trim the prefix/suffix that is already in place
+    left += gallop_right(arr[mid + 1], &arr[left], mid - left + 1);
+    if (left > mid) return;
+    right = mid + gallop_left(arr[mid], &arr[mid + 1], right - mid);
+
+    const size_t PREFETCH_DIST = 16;
+    size_t min_gallop = *min_gallop_state;
+    size_t i = left, j = mid + 1, k = left;
+
+    while (i <= mid && j <= right) {
+        size_t count_a = 0, count_b = 0;
+
+        do {
+            if (i + PREFETCH_DIST <= mid) PREFETCH(&arr[i + PREFETCH_DIST]);
+            if (j + PREFETCH_DIST <= right) PREFETCH(&arr[j + PREFETCH_DIST]);
+
+            if (cmp_le(arr[i], arr[j])) {
+                temp[k++] = arr[i++];
+                count_a++;
+                count_b = 0;
+            } else {
+                temp[k++] = arr[j++];
+                count_b++;
+                count_a = 0;
+            }
+        } while (i <= mid && j <= right && count_a + count_b < min_gallop);
+        if (i > mid || j > right) break;
+
+        min_gallop++;
+        do {
+            if (min_gallop > 1) min_gallop--;
+
+            count_a = gallop_right(arr[j], &arr[i], mid - i + 1);
+            memcpy(&temp[k], &arr[i], count_a * sizeof(T));
+            k += count_a;
+            i += count_a;
+            if (i > mid) break;
+            temp[k++] = arr[j++];
+            if (j > right) break;
+
+            count_b = gallop_left(arr[i], &arr[j], right - j + 1);
+            memcpy(&temp[k], &arr[j], count_b * sizeof(T));
+            k += count_b;
+            j += count_b;
+            if (j > right) break;
+            temp[k++] = arr[i++];
+            if (i > mid) break;
+        } while (count_a >= MIN_GALLOP || count_b >= MIN_GALLOP);
+        min_gallop++;  // penalty for leaving galloping mode
+    }
+    *min_gallop_state = min_gallop;
+
+    if (i <= mid) memcpy(&temp[k], &arr[i], (mid - i + 1) * sizeof(T));
+    else if (j <= right) memcpy(&temp[k], &arr[j], (right - j + 1) * sizeof(T));
+
+    memcpy(&arr[left], &temp[left], (right - left + 1) * sizeof(T));
+}
+
+static void timsort_prefetch_gallop(T *arr, size_t size, size_t run_size, T *temp) {
+    if (size <= 1) return;
+
+    for (size_t i = 0; i < size; i += run_size) {
+        size_t right = (i + run_size - 1 < size - 1) ? i + run_size - 1 : size - 1;
+        insertion_sort_range(arr, i, right);
+    }
+
+    size_t min_gallop = MIN_GALLOP;
+    for (size_t curr_size = run_size; curr_size < size; curr_size *= 2) {
+        for (size_t left = 0; left < size; left += 2 * curr_size) {
+            size_t mid = left + curr_size - 1;
+            if (mid >= size - 1) break;
+            size_t right = (left + 2 * curr_size - 1 < size - 1) ?
+                           left + 2 * curr_size - 1 : size - 1;
+            merge_prefetch_gallop(arr, left, mid, right, temp, &min_gallop);
+        }
+    }
+}
+
+// ============================================================================
+// OPTIMIZATION 2c: PING-PONG MERGE BUFFERS
+// Each merge level reads from one buffer and writes to the other, so merged
+// ranges are never copied back. Only an odd level count costs a final copy.
+// ============================================================================
+
+static void merge_to(const T *src, size_t left, size_t mid, size_t right, T *dst) {
+    size_t i = left, j = mid + 1, k = left;
+
+    while (i <= mid && j <= right) {
+        if (cmp_le(src[i], src[j])) {
+            dst[k++] = src[i++];
+        } else {
+            dst[k++] = src[j++];
+        }
+    }
+    while (i <= mid) dst[k++] = src[i++];
+    while (j <= right) dst[k++] = src[j++];
+}
+
+static void timsort_pingpong(T *arr, size_t size, size_t run_size, T *temp) {
+    if (size <= 1) return;
+
+    for (size_t i = 0; i < size; i += run_size) {
+        size_t right = (i + run_size - 1 < size - 1) ? i + run_size - 1 : size - 1;
+        insertion_sort_range(arr, i, right);
+    }
+
+    T *src = arr, *dst = temp;
+    for (size_t curr_size = run_size; curr_size < size; curr_size *= 2) {
+        for (size_t left = 0; left < size; left += 2 * curr_size) {
+            size_t mid = left + curr_size - 1;
+            if (mid >= size - 1) {
+                memcpy(&dst[left], &src[left], (size - left) * sizeof(T));
+                break;
+            }
+            size_t right = (left + 2 * curr_size - 1 < size - 1) ?
+                           left + 2 * curr_size - 1 : size - 1;
+            merge_to(src, left, mid, right, dst);
+        }
+        T *swap = src;
+        src = dst;
+        dst = swap;
+    }
+
+    if (src != arr) memcpy(arr, src, size * sizeof(T));
+}
+
+// ============================================================================
+// OPTIMIZATION 2d: SIMD BITONIC MERGE
+// Ping-pong merge levels where each merge runs a bitonic merge network on
+// 16 (AVX-512) or 8 (AVX2) keys per step; simd_sort.c picks the kernel from
+// CPUID at run time and falls back to a scalar merge elsewhere.
+// ============================================================================
+
+_Static_assert(_Generic((T)0, uint32_t: 1, default: 0),
+               "SIMD merge kernels are implemented for uint32_t keys only");
+
+// merge sorted run_size blocks of arr up to size, alternating arr and temp
+static void simd_merge_levels(T *arr, size_t size, size_t run_size, T *temp) {
+    T *src = arr, *dst = temp;
+    for (size_t curr_size = run_size; curr_size < size; curr_size *= 2) {
+        for (size_t left = 0; left < size; left += 2 * curr_size) {
+            size_t mid = left + curr_size;
+            if (mid >= size) {
+                memcpy(&dst[left], &src[left], (size - left) * sizeof(T));
+                break;
+            }
+            size_t right = (left + 2 * curr_size < size) ? left + 2 * curr_size : size;
+            simd_merge_u32(&src[left], mid - left, &src[mid], right - mid, &dst[left]);
+        }
+        T *swap = src;
+        src = dst;
+        dst = swap;
+    }
+
+    if (src != arr) memcpy(arr, src, size * sizeof(T));
+}
+
+static void timsort_simd(T *arr, size_t size, size_t run_size, T *temp) {
+    if (size <= 1) return;
+
+    for (size_t i = 0; i < size; i += run_size) {
+        size_t right = (i + run_size - 1 < size - 1) ? i + run_size - 1 : size - 1;
+        insertion_sort_range(arr, i, right);
+    }
+    simd_merge_levels(arr, size, run_size, temp);
+}
+
+// ============================================================================
+// OPTIMIZATION 2e: SIMD SORTING NETWORKS FOR RUN FORMATION
+// Instead of quadratic insertion sort, each RUN block is cut into 16- or
+// 8-key register blocks sorted by a bitonic sorting network, which are then
+// merged up to RUN with the vector merge (binary insertion sort on hosts
+// without AVX2). This makes large RUN sizes cheap to form.
+// ============================================================================
+
+static void timsort_simd_net(T *arr, size_t size, size_t run_size, T *temp) {
+    if (size <= 1) return;
+
+    // each block uses its own slice of temp as scratch
+    for (size_t i = 0; i < size; i += run_size) {
+        size_t len = (size - i < run_size) ? size - i : run_size;
+        simd_sort_run_u32(&arr[i], len, &temp[i]);
+    }
+    simd_merge_levels(arr, size, run_size, temp);
+}
+
 // ============================================================================
 // OPTIMIZATION 3: RADIX SORT (LSD - Least Significant Digit)
 // Non-comparison sort - O(n*k) where k = number of digits
@@ -273,34 +664,71 @@ static void timsort_prefetch(T *arr, size_t size, size_t run_size, T *temp) {
 #define RADIX_BITS 8
 #define RADIX_SIZE (1 << RADIX_BITS)  // 256 buckets
 #define RADIX_MASK (RADIX_SIZE - 1)
+#define RADIX_KEY(x) (x)
+
+// Scatter through per-bucket write-combining buffers with streaming stores; used
+// for arrays of stream_min_bytes or more, which no cache level could hold anyway
+DEFINE_STREAM_SCATTER(radix_scatter_stream, T, RADIX_KEY)
 
 static void radix_sort_lsd(T *arr, size_t size, T *temp) {
     if (size <= 1) return;
     
-    size_t count[RADIX_SIZE];
+    enum { PASSES = (int)(sizeof(T) * 8 / RADIX_BITS) };
+    size_t count[PASSES][RADIX_SIZE];
     
-    // Process each byte (4 passes for uint32_t)
-    for (int shift = 0; shift < (int)(sizeof(T) * 8); shift += RADIX_BITS) {
-        // Count occurrences
-        memset(count, 0, sizeof(count));
-        for (size_t i = 0; i < size; i++) {
-            size_t digit = (arr[i] >> shift) & RADIX_MASK;
-            count[digit]++;
+    // One read pass builds the histograms of every digit (4 for uint32_t)
+    memset(count, 0, sizeof(count));
+    for (size_t i = 0; i < size; i++) {
+        T x = arr[i];
+        for (int p = 0; p < PASSES; p++) {
+            count[p][(x >> (p * RADIX_BITS)) & RADIX_MASK]++;
         }
+    }
+    traffic_bytes += size * sizeof(T);
+    
+    // Passes alternate between arr and temp instead of copying back
+    int stream = stream_wanted(size * sizeof(T));
+    T *src = arr, *dst = temp;
+    for (int p = 0; p < PASSES; p++) {
+        int shift = p * RADIX_BITS;
+        
+        // Every key has the same digit here (e.g. the top byte of rand() values
+        // or small key ranges): the pass would not move anything
+        if (count[p][(src[0] >> shift) & RADIX_MASK] == size) continue;
         
-        // Compute prefix sums (cumulative count)
-        for (size_t i = 1; i < RADIX_SIZE; i++) {
-            count[i] += count[i - 1];
+        // Exclusive prefix sums: first output slot of each digit
+        size_t sum = 0;
+        for (size_t d = 0; d < RADIX_SIZE; d++) {
+            size_t c = count[p][d];
+            count[p][d] = sum;
+            sum += c;
         }
         
-        // Place elements in sorted order (iterate backwards for stability)
-        for (size_t i = size; i > 0; i--) {
-            size_t digit = (arr[i-1] >> shift) & RADIX_MASK;
-            temp[--count[digit]] = arr[i-1];
+        // Place elements front to back (stable)
+        if (stream) {
+            radix_scatter_stream(src, dst, size, shift, count[p]);
+        } else {
+            for (size_t i = 0; i < size; i++) {
+                T x = src[i];
+                dst[count[p][(x >> shift) & RADIX_MASK]++] = x;
+            }
         }
+        traffic_bytes += 2 * size * sizeof(T);
         
-        // Copy back
-        memcpy(arr, temp, size * sizeof(T));
+        T *swap = src;
+        src = dst;
+        dst = swap;
+    }
+    
+    // Odd number of executed passes: result is in temp
+    if (src != arr) {
+        if (stream) {
+            stream_copy(arr, src, size * sizeof(T));
+            stream_fence();
+        } else {
+            memcpy(arr, src, size * sizeof(T));
+        }
+        traffic_bytes += 2 * size * sizeof(T);
     }
 }
 
@@ -327,6 +755,7 @@ typedef struct {
     const char *name;
     sort_func_t func;
     size_t param;  // e.g., RUN size
+    int cmp_extern; // compares outside this file; comparisons reported as -1
 } SortAlgorithm;
 
 // Wrapper functions for uniform interface
@@ -334,10 +763,33 @@ static void wrap_timsort(T *arr, size_t size, size_t run, T *temp) {
     timsort_with_run(arr, size, run, temp);
 }
 
+static void wrap_timsort_branchless(T *arr, size_t size, size_t run, T *temp) {
+    timsort_branchless(arr, size, run, temp);
+}
+
 static void wrap_timsort_prefetch(T *arr, size_t size, size_t run, T *temp) {
     timsort_prefetch(arr, size, run, temp);
 }
 
+static void wrap_timsort_prefetch_gallop(T *arr, size_t size, size_t run, T *temp) {
+    timsort_prefetch_gallop(arr, size, run, temp);
+}
+
+static void wrap_timsort_pingpong(T *arr, size_t size, size_t run, T *temp) {
+    timsort_pingpong(arr, size, run, temp);
+    traffic_bytes = merge_traffic(size, run);
+}
+
+static void wrap_timsort_simd(T *arr, size_t size, size_t run, T *temp) {
+    timsort_simd(arr, size, run, temp);
+    traffic_bytes = merge_traffic(size, run);
+}
+
+static void wrap_timsort_simd_net(T *arr, size_t size, size_t run, T *temp) {
+    timsort_simd_net(arr, size, run, temp);
+    traffic_bytes = merge_traffic(size, run);
+}
+
 static void wrap_radix(T *arr, size_t size, size_t unused, T *temp) {
     (void)unused;
     radix_sort_lsd(arr, size, temp);
@@ -348,6 +800,159 @@ static void wrap_radix_hybrid(T *arr, size_t size, size_t unused, T *temp) {
     radix_sort_hybrid(arr, size, temp);
 }
 
+// Same as radix_lsd, with streaming stores at every size instead of only from
+// stream_min_bytes up (compare the two at sizes above the LLC)
+static void wrap_radix_nt(T *arr, size_t size, size_t unused, T *temp) {
+    (void)unused;
+    size_t saved = stream_min_bytes;
+    stream_min_bytes = 0;
+    radix_sort_lsd(arr, size, temp);
+    stream_min_bytes = saved;
+}
+
+// Samples the input, then runs timsort, LSD/MSD radix or the parallel samplesort
+static void wrap_sort_auto(T *arr, size_t size, size_t unused, T *temp) {
+    (void)unused;
+    (void)temp;
+    sort_plan_t plan = sort_auto(arr, size);
+    row_detail = sort_alg_name(plan.alg);
+    scratch_bytes = (plan.alg == SORT_RADIX_MSD || plan.alg == SORT_COUNTING) ? 0 : size * sizeof(T);
+}
+
+// Counting sort; falls back to radix_lsd (shown as counting_sort[radix_lsd]) when
+// the keys are neither in a small range nor few
+static void wrap_counting(T *arr, size_t size, size_t unused, T *temp) {
+    (void)unused;
+    if (!counting_sort_u32(arr, size, &scratch_bytes)) {
+        radix_sort_lsd(arr, size, temp);
+        scratch_bytes = size * sizeof(T);
+        row_detail = "radix_lsd";
+    } else {
+        traffic_bytes = 3 * size * sizeof(T);   // min/max read, count read, fill write
+    }
+}
+
+static void wrap_radix_msd(T *arr, size_t size, size_t unused, T *temp) {
+    (void)unused;
+    (void)temp;
+    radix_sort_msd_u32(arr, size);
+    scratch_bytes = 0;
+}
+
+// Library timsort(): natural runs + computed minrun + balanced run stack. An empty
+// workspace allocates and frees scratch as timsort() does, and reports the bytes
+// actually moved (merges skipped over natural runs cost nothing)
+static void wrap_timsort_adaptive(T *arr, size_t size, size_t unused, T *temp) {
+    (void)unused;
+    (void)temp;
+    timsort_ws_t ws;
+    timsort_ws_init(&ws, 0, TIMSORT_PINGPONG, false);
+    timsort_with_ws(&ws, arr, size);
+    scratch_bytes = ws.temp_cap * sizeof(T);
+    traffic_bytes = ws.traffic_bytes;
+    timsort_ws_free(&ws);
+}
+
+// Same, with the streaming final merge levels forced on at every size
+static void wrap_timsort_adaptive_nt(T *arr, size_t size, size_t unused, T *temp) {
+    size_t saved = stream_min_bytes;
+    stream_min_bytes = 0;
+    wrap_timsort_adaptive(arr, size, unused, temp);
+    stream_min_bytes = saved;
+}
+
+// Same, with a fixed 256-element stack buffer and rotation-based merges (O(1) extra memory)
+static void wrap_timsort_inplace(T *arr, size_t size, size_t unused, T *temp) {
+    (void)unused;
+    (void)temp;
+    scratch_bytes = timsort_mode(arr, size, TIMSORT_INPLACE);
+}
+
+// Same, reusing one pre-faulted workspace across calls (no malloc or page faults in the timed run)
+static timsort_ws_t bench_ws;
+
+static void wrap_timsort_adaptive_ws(T *arr, size_t size, size_t unused, T *temp) {
+    (void)unused;
+    (void)temp;
+    timsort_with_ws(&bench_ws, arr, size);
+    scratch_bytes = bench_ws.temp_cap * sizeof(T);
+    traffic_bytes = bench_ws.traffic_bytes;
+}
+
+// Same, but merges copy only the smaller run out (scratch <= n/2)
+static void wrap_timsort_adaptive_half(T *arr, size_t size, size_t unused, T *temp) {
+    (void)unused;
+    (void)temp;
+    scratch_bytes = timsort_mode(arr, size, TIMSORT_HALF_BUFFER);
+}
+
+// ============================================================================
+// 5. KEY-TYPE COVERAGE: the per-type timsort instances (timsort_mode_u64, ...)
+// and radix sorts (radix_sort_i32, ...)
+// ============================================================================
+
+// Each row sorts the same distribution mapped order-preservingly onto another key
+// type, so rows are comparable with timsort_adaptive / radix_lsd (uint32).
+typedef int (*typed_bench_t)(const T *src, size_t size, int num_runs, metrics_t *m);
+
+typedef struct {
+    const char *name;
+    typed_bench_t func;
+    size_t elem_bytes;
+} TypedAlgorithm;
+
+// sort: expression sorting work[0..size) (scratch holds size elements) that
+// yields the scratch bytes it used
+#define DEFINE_TYPED_RUNNER(fname, type, conv, sort)                                    \
+static int fname(const T *src, size_t size, int num_runs, metrics_t *m) {               \
+    type *work = (type *)sort_buf_alloc(size * sizeof(type), buf_prefault);             \
+    type *scratch = (type *)sort_buf_alloc(size * sizeof(type), buf_prefault);          \
+    double total = 0.0;                                                                 \
+    size_t peak = 0;                                                                    \
+    long faults = 0;                                                                    \
+    long long misses = 0;                                                               \
+    int ok = work && scratch;                                                           \
+    for (int run = -1; run < num_runs && ok; run++) {  /* run -1 is the warmup */       \
+        for (size_t i = 0; i < size; i++) {                                             \
+            T x = src[i];                                                               \
+            work[i] = (conv);                                                           \
+        }                                                                               \
+        double t0;                                                                      \
+        metrics_begin(&t0);                                                             \
+        size_t s = (sort);                                                              \
+        metrics_end(m, t0);                                                             \
+        if (run >= 0) {                                                                 \
+            total += m->elapsed_sec;                                                    \
+            faults += m->page_faults;                                                   \
+            if (misses >= 0)                                                            \
+                misses = m->dtlb_misses < 0 ? -1 : misses + m->dtlb_misses;             \
+        }                                                                               \
+        if (s > peak) peak = s;                                                         \
+        for (size_t i = 1; i < size; i++)                                               \
+            if (work[i] < work[i-1]) ok = 0;                                            \
+    }                                                                                   \
+    m->elapsed_sec = total / num_runs;                                                  \
+    m->scratch_bytes = peak;                                                            \
+    m->page_faults = faults / num_runs;                                                 \
+    m->dtlb_misses = misses < 0 ? -1 : misses / num_runs;                               \
+    sort_buf_free(work);                                                                \
+    sort_buf_free(scratch);                                                             \
+    return ok;                                                                          \
+}
+
+#define DEFINE_TYPED_BENCH(type, sfx, conv)                                             \
+    DEFINE_TYPED_RUNNER(bench_typed_##sfx, type, conv,                                  \
+                        timsort_mode_##sfx(work, size, TIMSORT_PINGPONG))               \
+    DEFINE_TYPED_RUNNER(bench_radix_##sfx, type, conv,                                  \
+                        (radix_sort_##sfx(work, size, scratch), size * sizeof(type)))
+
+DEFINE_TYPED_BENCH(uint32_t, u32, x)
+DEFINE_TYPED_BENCH(uint64_t, u64, ((uint64_t)x << 32) | x)
+DEFINE_TYPED_BENCH(int32_t,  i32, (int32_t)(x ^ 0x80000000u))
+DEFINE_TYPED_BENCH(int64_t,  i64, (int64_t)((((uint64_t)x << 32) | x) ^ (1ULL << 63)))
+DEFINE_TYPED_BENCH(float,    f32, (float)x - 2147483648.0f)
+DEFINE_TYPED_BENCH(double,   f64, (double)x - 2147483648.0)
+
 // Run single benchmark
 static int benchmark_single(sort_func_t func, T *src, size_t size, size_t param, T *work, T *temp, int warmup, metrics_t *m) {
     
@@ -359,9 +964,15 @@ static int benchmark_single(sort_func_t func, T *src, size_t size, size_t param,
     }
 
     double t0;
+    cmp_count = 0;
+    scratch_bytes = size * sizeof(T);
+    traffic_bytes = 0;
     metrics_begin(&t0);
     func(work, size, param, temp);
     metrics_end(m, t0);
+    m->comparisons = cmp_count;
+    m->scratch_bytes = scratch_bytes;
+    m->traffic_bytes = traffic_bytes;
 
     if (!verify_sorted(work, size)) {
         printf("VERIFICATION FAILED!\n");
@@ -388,19 +999,36 @@ int main(int argc, char *argv[]) {
     if (argc > 2) {
         num_runs = atoi(argv[2]);
     }
+    // "malloc" turns the huge-page layer off everywhere (library scratch included)
+    // and leaves the buffers unfaulted, for a before/after comparison
+    int huge = !(argc > 3 && strcmp(argv[3], "malloc") == 0);
+    if (!huge) {
+        sort_buf_huge_min = SIZE_MAX;
+        buf_prefault = false;
+    }
+    tlb_counters_open();
     
     double size_gb = (double)(size * sizeof(T)) / (1024.0 * 1024.0 * 1024.0);
     printf("=== Sorting Benchmark ===\n");
     printf("Array size: %zu elements (%.3f GB)\n", size, size_gb);
     printf("Data type: %zu bytes\n", sizeof(T));
-    printf("Runs per test: %d\n\n", num_runs);
+    printf("Runs per test: %d\n", num_runs);
+    printf("SIMD merge kernel: %s\n", simd_isa());
+    printf("Streaming stores: %s, from %zu MB\n", STREAM_NT ? "sse2" : "none", stream_min_bytes >> 20);
+    if (huge)
+        printf("Sort buffers: 2 MB-aligned MADV_HUGEPAGE mappings from %zu MB, pre-faulted\n",
+               sort_buf_huge_min >> 20);
+    else
+        printf("Sort buffers: malloc\n");
+    printf("dTLB miss counters: %s\n\n", tlb_fd[0] >= 0 || tlb_fd[1] >= 0 ? "perf" : "unavailable");
     
     // Allocate arrays
-    T *source = (T *)malloc(size * sizeof(T));
-    T *work = (T *)malloc(size * sizeof(T));
-    T *temp = (T *)malloc(size * sizeof(T));
+    T *source = (T *)sort_buf_alloc(size * sizeof(T), buf_prefault);
+    T *work = (T *)sort_buf_alloc(size * sizeof(T), buf_prefault);
+    T *temp = (T *)sort_buf_alloc(size * sizeof(T), buf_prefault);
     
-    if (!source || !work || !temp) {
+    if (!source || !work || !temp ||
+        !timsort_ws_init(&bench_ws, size, TIMSORT_PINGPONG, true)) {
         fprintf(stderr, "Failed to allocate memory!\n");
         return 1;
     }
@@ -408,20 +1036,66 @@ int main(int argc, char *argv[]) {
     // Define algorithms to test
     SortAlgorithm algorithms[] = {
         // Timsort variants with different RUN sizes
-        {"timsort_run32",      wrap_timsort,          RUN_SMALL},
-        {"timsort_run64",      wrap_timsort,          RUN_MEDIUM},
-        {"timsort_run128",     wrap_timsort,          RUN_LARGE},
-        {"timsort_run256",     wrap_timsort,          RUN_XLARGE},
-        {"timsort_run512",     wrap_timsort,          RUN_CACHE},
+        {"timsort_run32",      wrap_timsort,          RUN_SMALL,  0},
+        {"timsort_run64",      wrap_timsort,          RUN_MEDIUM, 0},
+        {"timsort_run128",     wrap_timsort,          RUN_LARGE,  0},
+        {"timsort_run256",     wrap_timsort,          RUN_XLARGE, 0},
+        {"timsort_run512",     wrap_timsort,          RUN_CACHE,  0},
+        // Branchless merge kernel (compare against timsort_run*)
+        {"timsort_branchless_run64",  wrap_timsort_branchless, RUN_MEDIUM, 0},
+        {"timsort_branchless_run128", wrap_timsort_branchless, RUN_LARGE,  0},
+        {"timsort_branchless_run256", wrap_timsort_branchless, RUN_XLARGE, 0},
         // Prefetch variants
-        {"timsort_pf_run64",   wrap_timsort_prefetch, RUN_MEDIUM},
-        {"timsort_pf_run128",  wrap_timsort_prefetch, RUN_LARGE},
-        {"timsort_pf_run256",  wrap_timsort_prefetch, RUN_XLARGE},
+        {"timsort_pf_run64",   wrap_timsort_prefetch, RUN_MEDIUM, 0},
+        {"timsort_pf_run128",  wrap_timsort_prefetch, RUN_LARGE,  0},
+        {"timsort_pf_run256",  wrap_timsort_prefetch, RUN_XLARGE, 0},
+        // Galloping merge variants (compare against timsort_pf_run*)
+        {"timsort_pf_gallop_run64",  wrap_timsort_prefetch_gallop, RUN_MEDIUM, 0},
+        {"timsort_pf_gallop_run128", wrap_timsort_prefetch_gallop, RUN_LARGE,  0},
+        // Ping-pong merge buffers (compare against timsort_run*)
+        {"timsort_pp_run64",   wrap_timsort_pingpong, RUN_MEDIUM, 0},
+        {"timsort_pp_run128",  wrap_timsort_pingpong, RUN_LARGE,  0},
+        // SIMD bitonic merge (kernel chosen from CPUID)
+        {"timsort_simd_run64",  wrap_timsort_simd,    RUN_MEDIUM, 1},
+        {"timsort_simd_run128", wrap_timsort_simd,    RUN_LARGE,  1},
+        // SIMD sorting-network run formation + SIMD merge
+        {"timsort_simd_net_run64",  wrap_timsort_simd_net, RUN_MEDIUM, 1},
+        {"timsort_simd_net_run128", wrap_timsort_simd_net, RUN_LARGE,  1},
+        {"timsort_simd_net_run256", wrap_timsort_simd_net, RUN_XLARGE, 1},
+        {"timsort_simd_net_run512", wrap_timsort_simd_net, RUN_CACHE,  1},
+        // Adaptive (natural-run) timsort from timsort.c
+        {"timsort_adaptive",   wrap_timsort_adaptive, 0, 1},
+        {"timsort_adaptive_nt", wrap_timsort_adaptive_nt, 0, 1},
+        {"timsort_adaptive_half", wrap_timsort_adaptive_half, 0, 1},
+        {"timsort_adaptive_ws", wrap_timsort_adaptive_ws, 0, 1},
+        {"timsort_inplace",    wrap_timsort_inplace,  0, 1},
         // Radix sort
-        {"radix_lsd",          wrap_radix,            0},
-        {"radix_hybrid",       wrap_radix_hybrid,     0},
+        {"radix_lsd",          wrap_radix,            0, 0},
+        {"radix_lsd_nt",       wrap_radix_nt,         0, 0},
+        {"radix_hybrid",       wrap_radix_hybrid,     0, 0},
+        {"radix_msd_inplace",  wrap_radix_msd,        0, 1},  // insertion sort inside radix_sort.c
+        {"counting_sort",      wrap_counting,         0, 0},
+        // Sampling dispatcher; the chosen algorithm is printed as sort_auto[choice]
+        {"sort_auto",          wrap_sort_auto,        0, 1},
     };
     size_t num_algorithms = sizeof(algorithms) / sizeof(algorithms[0]);
+
+    // Same adaptive timsort and LSD radix, one row per key type
+    TypedAlgorithm typed[] = {
+        {"timsort_adaptive_u32", bench_typed_u32, sizeof(uint32_t)},
+        {"timsort_adaptive_u64", bench_typed_u64, sizeof(uint64_t)},
+        {"timsort_adaptive_i32", bench_typed_i32, sizeof(int32_t)},
+        {"timsort_adaptive_i64", bench_typed_i64, sizeof(int64_t)},
+        {"timsort_adaptive_f32", bench_typed_f32, sizeof(float)},
+        {"timsort_adaptive_f64", bench_typed_f64, sizeof(double)},
+        {"radix_lsd_u32",        bench_radix_u32, sizeof(uint32_t)},
+        {"radix_lsd_u64",        bench_radix_u64, sizeof(uint64_t)},
+        {"radix_lsd_i32",        bench_radix_i32, sizeof(int32_t)},
+        {"radix_lsd_i64",        bench_radix_i64, sizeof(int64_t)},
+        {"radix_lsd_f32",        bench_radix_f32, sizeof(float)},
+        {"radix_lsd_f64",        bench_radix_f64, sizeof(double)},
+    };
+    size_t num_typed = sizeof(typed) / sizeof(typed[0]);
     
     // Distributions to test
     Distribution distributions[] = {
@@ -434,7 +1108,8 @@ int main(int argc, char *argv[]) {
     
     // Print CSV header
     printf("algorithm,distribution,size,time_sec,throughput_MB_s,");
-    printf("memory_MB,cost_per_GB\n");
+    printf("memory_MB,cost_per_GB,comparisons,max_rss_MB,bandwidth_GB_s,");
+    printf("page_faults,dtlb_misses\n");
 
     for (size_t d = 0; d < num_distributions; d++) {
         Distribution dist = distributions[d];
@@ -445,6 +1120,12 @@ int main(int argc, char *argv[]) {
 
             double total_time = 0.0;
             long peak_rss_kb = 0;
+            uint64_t comparisons = 0;
+            size_t peak_scratch = 0;
+            size_t traffic = 0;
+            long faults = 0;
+            long long misses = 0;
+            row_detail = NULL;
 
             for (int run = 0; run < num_runs; run++) {
                 metrics_t m;
@@ -462,31 +1143,84 @@ int main(int argc, char *argv[]) {
                 total_time += m.elapsed_sec;
                 if (m.max_rss_kb > peak_rss_kb)
                     peak_rss_kb = m.max_rss_kb;
+                comparisons = m.comparisons;
+                if (m.scratch_bytes > peak_scratch)
+                    peak_scratch = m.scratch_bytes;
+                traffic = m.traffic_bytes;
+                faults += m.page_faults;
+                if (misses >= 0)
+                    misses = m.dtlb_misses < 0 ? -1 : misses + m.dtlb_misses;
             }
 
             double avg_time_sec = total_time / num_runs;
             double throughput_MB =
                 (size * sizeof(T) / (1024.0 * 1024.0)) / avg_time_sec;
 
-            double hourly_cost = 0.50; // CloudLab-style example
             double cost_per_GB =
-                (hourly_cost / 3600.0) * (avg_time_sec / size_gb);
+                (HOURLY_COST / 3600.0) * (avg_time_sec / size_gb);
 
-            printf("%s,%s,%zu,%.6f,%.2f,%.2f,%.8f\n",
-                alg->name,
+            // working array + algorithm scratch (RSS is process-wide and never drops)
+            double memory_MB =
+                (size * sizeof(T) + peak_scratch) / (1024.0 * 1024.0);
+
+            // effective memory bandwidth of the passes the row reports
+            double bandwidth_GB =
+                traffic ? traffic / (1024.0 * 1024.0 * 1024.0) / avg_time_sec : -1.0;
+
+            char name[64];
+            snprintf(name, sizeof(name), row_detail ? "%s[%s]" : "%s", alg->name, row_detail);
+
+            printf("%s,%s,%zu,%.6f,%.2f,%.2f,%.8f,%lld,%.2f,%.2f,%ld,%lld\n",
+                name,
                 dist_name(dist),
                 size,
                 avg_time_sec,
                 throughput_MB,
+                memory_MB,
+                cost_per_GB,
+                (alg->cmp_extern || !BENCH_COUNT_CMP) ? -1LL : (long long)comparisons,
                 peak_rss_kb / 1024.0,   // MB
-                cost_per_GB);
+                bandwidth_GB,
+                faults / num_runs,      // per run
+                misses < 0 ? -1LL : misses / num_runs);
+        }
+
+        for (size_t a = 0; a < num_typed; a++) {
+            TypedAlgorithm *alg = &typed[a];
+            metrics_t m;
+
+            if (!alg->func(source, size, num_runs, &m)) {
+                printf("ERROR in %s\n", alg->name);
+                continue;
+            }
+
+            double bytes = (double)size * alg->elem_bytes;
+            double throughput_MB = (bytes / (1024.0 * 1024.0)) / m.elapsed_sec;
+            double cost_per_GB = (HOURLY_COST / 3600.0) *
+                (m.elapsed_sec / (bytes / (1024.0 * 1024.0 * 1024.0)));
+            double memory_MB = (bytes + m.scratch_bytes) / (1024.0 * 1024.0);
+
+            printf("%s,%s,%zu,%.6f,%.2f,%.2f,%.8f,%lld,%.2f,%.2f,%ld,%lld\n",
+                alg->name,
+                dist_name(dist),
+                size,
+                m.elapsed_sec,
+                throughput_MB,
+                memory_MB,
+                cost_per_GB,
+                -1LL,
+                m.max_rss_kb / 1024.0,  // MB
+                -1.0,
+                m.page_faults,
+                m.dtlb_misses);
         }
     }
 
     
-    free(source);
-    free(work);
-    free(temp);
+    sort_buf_free(source);
+    sort_buf_free(work);
+    sort_buf_free(temp);
+    timsort_ws_free(&bench_ws);
     
     printf("\n=== Benchmark Complete ===\n");
     return 0;
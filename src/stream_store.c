@@ -0,0 +1,3 @@
+#include "stream_store.h"
+
+size_t stream_min_bytes = STREAM_MIN_BYTES;
@@ -0,0 +1,115 @@
+#ifndef STREAM_STORE_H
+#define STREAM_STORE_H
+
+#include <stdalign.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define STREAM_NT 1
+#else
+#define STREAM_NT 0
+#endif
+
+// Non-temporal (streaming) stores for outputs far larger than the last-level
+// cache: the destination lines are written through write-combining buffers
+// instead of being read for ownership first. On hosts without SSE2 every
+// helper degrades to plain copies.
+
+#ifndef STREAM_MIN_BYTES
+#define STREAM_MIN_BYTES ((size_t)64 << 20)   // above a typical per-socket LLC
+#endif
+#define STREAM_LINE 64
+
+// Outputs of at least this many bytes use the streaming paths in timsort.c and
+// radix_sort.c. 0 streams everything, SIZE_MAX nothing; not thread-safe to change
+// while sorts are running.
+extern size_t stream_min_bytes;
+
+static inline int stream_wanted(size_t bytes) {
+    return STREAM_NT && bytes >= stream_min_bytes;
+}
+
+// Order the streaming stores before anything that follows (another thread may read dst)
+static inline void stream_fence(void) {
+#if STREAM_NT
+    _mm_sfence();
+#endif
+}
+
+// Write one 64-byte-aligned line from src (also 16-byte aligned)
+static inline void stream_line(void *dst, const void *src) {
+#if STREAM_NT
+    const __m128i *s = (const __m128i *)src;
+    __m128i *d = (__m128i *)dst;
+    _mm_stream_si128(d + 0, _mm_load_si128(s + 0));
+    _mm_stream_si128(d + 1, _mm_load_si128(s + 1));
+    _mm_stream_si128(d + 2, _mm_load_si128(s + 2));
+    _mm_stream_si128(d + 3, _mm_load_si128(s + 3));
+#else
+    memcpy(dst, src, STREAM_LINE);
+#endif
+}
+
+// Copy with streaming stores for the 16-byte-aligned middle of dst. Forward copy:
+// dst may overlap src as long as dst <= src.
+static inline void stream_copy(void *dst, const void *src, size_t bytes) {
+#if STREAM_NT
+    char *d = (char *)dst;
+    const char *s = (const char *)src;
+    size_t head = (16 - (uintptr_t)d % 16) % 16;
+    if (head >= bytes) {
+        memmove(d, s, bytes);
+        return;
+    }
+    memmove(d, s, head);
+    d += head;
+    s += head;
+    bytes -= head;
+    for (; bytes >= 16; bytes -= 16, d += 16, s += 16) {
+        _mm_stream_si128((__m128i *)d, _mm_loadu_si128((const __m128i *)s));
+    }
+    memmove(d, s, bytes);
+#else
+    memmove(dst, src, bytes);
+#endif
+}
+
+// Stable radix scatter of src[0..n) into dst by the byte of KEY(x) at shift, with
+// offset[256] holding each bucket's first slot (advanced past its last one on
+// return). Each bucket collects keys in a cache-line buffer whose slots mirror
+// dst's line layout, so full lines go out as one streaming write; a bucket's
+// partial first and last lines are written with plain stores.
+#define DEFINE_STREAM_SCATTER(name, type, KEY)                                  \
+static void name(const type *src, type *dst, size_t n, int shift, size_t *offset) { \
+    enum { L = STREAM_LINE / sizeof(type) };                                    \
+    alignas(STREAM_LINE) type wc[256][L];                                       \
+    size_t start[256];                                                          \
+    size_t lead = ((uintptr_t)dst % STREAM_LINE) / sizeof(type);                \
+    memcpy(start, offset, sizeof(start));                                       \
+                                                                                \
+    for (size_t i = 0; i < n; i++) {                                            \
+        type x = src[i];                                                        \
+        size_t d = (KEY(x) >> shift) & 0xFF;                                    \
+        size_t o = offset[d]++;                                                 \
+        wc[d][(o + lead) % L] = x;                                              \
+        if ((o + 1 + lead) % L != 0) continue;                                  \
+        if (o + 1 >= start[d] + L) {                                            \
+            stream_line(dst + o + 1 - L, wc[d]);                                \
+        } else {                                                                \
+            memcpy(dst + start[d], &wc[d][(start[d] + lead) % L],               \
+                   (o + 1 - start[d]) * sizeof(type));                          \
+        }                                                                       \
+    }                                                                           \
+                                                                                \
+    for (size_t d = 0; d < 256; d++) {                                          \
+        size_t end = offset[d], tail = (end + lead) % L;                        \
+        size_t from = end - start[d] > tail ? end - tail : start[d];            \
+        memcpy(dst + from, &wc[d][(from + lead) % L], (end - from) * sizeof(type)); \
+    }                                                                           \
+    stream_fence();                                                             \
+}
+
+#endif
@@ -0,0 +1,416 @@
+#define _GNU_SOURCE         // CPU sets and pthread_setaffinity_np
+#include "thread_pool.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define DEQUE_INIT_CAP 64
+#define SPIN_ROUNDS    64   // failed steal sweeps before an idle worker goes to sleep
+#define MAX_NODES      64
+#define ANY_NODE       ((size_t)-1)
+
+typedef struct {
+    void (*fn)(void *);
+    void *arg;
+    tpool_group_t *group;
+    size_t node;            // only workers of this node may run it (ANY_NODE: anyone)
+} task_t;
+
+// Ring buffer: the owner pushes and pops at tail, thieves take from head.
+// head and tail only grow; slot = index & (cap - 1).
+typedef struct {
+    pthread_mutex_t lock;
+    task_t *buf;
+    size_t cap;
+    size_t head;
+    size_t tail;
+    tpool_t *pool;
+    char pad[64];           // keep neighbouring deques' locks off one cache line
+} deque_t;
+
+struct tpool {
+    size_t nworkers;
+    pthread_t *threads;
+    deque_t *deques;        // one per worker
+    size_t nnodes;
+    size_t *node_of;        // node of each worker
+    size_t node_first[MAX_NODES + 1];   // workers of node j: [node_first[j], node_first[j + 1])
+    atomic_size_t queued;   // ANY_NODE tasks sitting in any deque
+    atomic_size_t queued_on[MAX_NODES];    // node-bound tasks, per node
+    atomic_size_t sleepers;
+    atomic_size_t next;     // round-robin target for spawns from outside the pool
+    atomic_bool stop;
+    pthread_mutex_t sleep_lock;
+    pthread_cond_t wake;
+};
+
+static __thread tpool_t *tls_pool;   // pool the current thread works for, if any
+static __thread size_t tls_worker;
+
+static bool deque_push(deque_t *d, task_t t) {
+    pthread_mutex_lock(&d->lock);
+    if (d->tail - d->head == d->cap) {
+        task_t *nb = (task_t *)malloc(2 * d->cap * sizeof(task_t));
+        if (!nb) {
+            pthread_mutex_unlock(&d->lock);
+            return false;
+        }
+        for (size_t i = d->head; i < d->tail; i++) {
+            nb[i & (2 * d->cap - 1)] = d->buf[i & (d->cap - 1)];
+        }
+        free(d->buf);
+        d->buf = nb;
+        d->cap *= 2;
+    }
+    d->buf[d->tail & (d->cap - 1)] = t;
+    d->tail++;
+    pthread_mutex_unlock(&d->lock);
+    return true;
+}
+
+static bool deque_pop(deque_t *d, task_t *t) {
+    bool ok = false;
+    pthread_mutex_lock(&d->lock);
+    if (d->tail != d->head) {
+        d->tail--;
+        *t = d->buf[d->tail & (d->cap - 1)];
+        ok = true;
+    }
+    pthread_mutex_unlock(&d->lock);
+    return ok;
+}
+
+// Take the oldest task that node may run, skipping tasks bound to other nodes;
+// the skipped ones move up one slot and keep their order
+static bool deque_steal(deque_t *d, task_t *t, size_t node) {
+    bool ok = false;
+    pthread_mutex_lock(&d->lock);
+    size_t mask = d->cap - 1;
+    for (size_t i = d->head; i != d->tail; i++) {
+        size_t tn = d->buf[i & mask].node;
+        if (tn != ANY_NODE && tn != node) continue;
+        *t = d->buf[i & mask];
+        for (; i != d->head; i--) d->buf[i & mask] = d->buf[(i - 1) & mask];
+        d->head++;
+        ok = true;
+        break;
+    }
+    pthread_mutex_unlock(&d->lock);
+    return ok;
+}
+
+// Queued tasks that a thread on node may run (ANY_NODE: threads outside the pool)
+static size_t runnable(tpool_t *pool, size_t node) {
+    size_t n = atomic_load(&pool->queued);
+    return node == ANY_NODE ? n : n + atomic_load(&pool->queued_on[node]);
+}
+
+static atomic_size_t *queue_count(tpool_t *pool, size_t node) {
+    return node == ANY_NODE ? &pool->queued : &pool->queued_on[node];
+}
+
+static void run_task(task_t *t) {
+    t->fn(t->arg);
+    atomic_fetch_sub(&t->group->pending, 1);
+}
+
+// Pop from our own deque (workers only), else sweep our node's deques and then
+// the rest once. A worker's deque only ever holds tasks for its own node or for
+// anyone; threads outside the pool only take the latter.
+static bool try_run_one(tpool_t *pool) {
+    task_t t;
+    bool self = (tls_pool == pool);
+    size_t start = self ? tls_worker : atomic_load(&pool->next);
+    size_t node = self ? pool->node_of[start] : ANY_NODE;
+    if (runnable(pool, node) == 0) return false;
+
+    if (self && deque_pop(&pool->deques[start], &t)) goto run;
+    size_t lo = self ? pool->node_first[node] : 0;
+    size_t hi = self ? pool->node_first[node + 1] : 0;
+    for (size_t k = self ? 1 : 0; k < pool->nworkers; k++) {
+        size_t w = (start + k) % pool->nworkers;
+        if ((w >= lo && w < hi) && deque_steal(&pool->deques[w], &t, node)) goto run;
+    }
+    for (size_t k = self ? 1 : 0; k < pool->nworkers; k++) {
+        size_t w = (start + k) % pool->nworkers;
+        if (!(w >= lo && w < hi) && deque_steal(&pool->deques[w], &t, node)) goto run;
+    }
+    return false;
+
+run:
+    atomic_fetch_sub(queue_count(pool, t.node), 1);
+    run_task(&t);
+    return true;
+}
+
+static void *worker_main(void *arg) {
+    deque_t *own = (deque_t *)arg;
+    tpool_t *pool = own->pool;
+    tls_pool = pool;
+    tls_worker = (size_t)(own - pool->deques);
+    size_t node = pool->node_of[tls_worker];
+
+    size_t idle = 0;
+    for (;;) {
+        if (try_run_one(pool)) {
+            idle = 0;
+            continue;
+        }
+        if (atomic_load(&pool->stop) && runnable(pool, node) == 0) break;
+        if (++idle < SPIN_ROUNDS) {
+            sched_yield();
+            continue;
+        }
+        // Sleep until a spawn sees us in sleepers; the count of tasks this worker
+        // may run is re-checked under the lock, so tasks bound to other nodes
+        // leave it asleep
+        pthread_mutex_lock(&pool->sleep_lock);
+        atomic_fetch_add(&pool->sleepers, 1);
+        while (runnable(pool, node) == 0 && !atomic_load(&pool->stop)) {
+            pthread_cond_wait(&pool->wake, &pool->sleep_lock);
+        }
+        atomic_fetch_sub(&pool->sleepers, 1);
+        pthread_mutex_unlock(&pool->sleep_lock);
+        idle = 0;
+    }
+    return NULL;
+}
+
+// ============================================================================
+// NUMA topology
+// ============================================================================
+
+#ifdef __linux__
+// Parse a sysfs list such as "0-3,8-11\n" (CPUs or nodes) into set
+static bool read_list(const char *path, cpu_set_t *set) {
+    FILE *f = fopen(path, "r");
+    if (!f) return false;
+    CPU_ZERO(set);
+    unsigned a, b;
+    while (fscanf(f, "%u", &a) == 1) {
+        b = a;
+        int c = fgetc(f);
+        if (c == '-') {
+            if (fscanf(f, "%u", &b) != 1) break;
+            c = fgetc(f);
+        }
+        for (unsigned i = a; i <= b && i < CPU_SETSIZE; i++) CPU_SET(i, set);
+        if (c != ',') break;
+    }
+    fclose(f);
+    return true;
+}
+
+// CPUs this process may use on each online node that has any; returns the
+// number of such nodes (0: no sysfs topology)
+static size_t read_topology(cpu_set_t *cpus) {
+    cpu_set_t allowed, online;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return 0;
+    if (!read_list("/sys/devices/system/node/online", &online)) return 0;
+    size_t n = 0;
+    for (int node = 0; node < CPU_SETSIZE && n < MAX_NODES; node++) {
+        if (!CPU_ISSET(node, &online)) continue;
+        char path[64];
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+        if (!read_list(path, &cpus[n])) continue;
+        CPU_AND(&cpus[n], &cpus[n], &allowed);
+        if (CPU_COUNT(&cpus[n]) > 0) n++;     // memory-only nodes get no workers
+    }
+    return n;
+}
+#endif
+
+// Give each node a share of the workers proportional to its CPUs; worker i goes
+// to the node holding the (i * total / nworkers)-th CPU. Nodes left without
+// workers are dropped and the rest renumbered; orig[] maps back. Returns the
+// number of nodes kept.
+static size_t assign_nodes(tpool_t *pool, const size_t *ncpus, size_t nn, size_t *orig) {
+    size_t total = 0;
+    for (size_t j = 0; j < nn; j++) total += ncpus[j];
+    size_t nodes = 0, j = 0, cum = 0;
+    for (size_t i = 0; i < pool->nworkers; i++) {
+        size_t cpu = i * total / pool->nworkers;
+        while (cpu >= cum + ncpus[j]) cum += ncpus[j++];
+        pool->node_of[i] = j;
+    }
+    for (size_t i = 0; i < pool->nworkers; i++) {
+        if (i == 0 || pool->node_of[i] != orig[nodes - 1]) {
+            orig[nodes] = pool->node_of[i];
+            pool->node_first[nodes++] = i;
+        }
+        pool->node_of[i] = nodes - 1;
+    }
+    pool->node_first[nodes] = pool->nworkers;
+    return nodes;
+}
+
+// ============================================================================
+// Pool
+// ============================================================================
+
+tpool_t *tpool_create(size_t nworkers) {
+    if (nworkers == 0) {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        nworkers = n > 0 ? (size_t)n : 1;
+    }
+    tpool_t *pool = (tpool_t *)calloc(1, sizeof(tpool_t));
+    if (!pool) return NULL;
+    pool->nworkers = nworkers;
+    pool->threads = (pthread_t *)calloc(nworkers, sizeof(pthread_t));
+    pool->deques = (deque_t *)calloc(nworkers, sizeof(deque_t));
+    pool->node_of = (size_t *)calloc(nworkers, sizeof(size_t));
+    if (!pool->threads || !pool->deques || !pool->node_of) goto fail;
+    for (size_t i = 0; i < nworkers; i++) {
+        pool->deques[i].buf = (task_t *)malloc(DEQUE_INIT_CAP * sizeof(task_t));
+        if (!pool->deques[i].buf) goto fail;
+        pool->deques[i].cap = DEQUE_INIT_CAP;
+        pool->deques[i].pool = pool;
+        pthread_mutex_init(&pool->deques[i].lock, NULL);
+    }
+    pthread_mutex_init(&pool->sleep_lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+
+    // One node unless sysfs shows several; workers are bound only in that case
+    size_t ncpus[MAX_NODES] = {0};
+    size_t nn = 0;
+#ifdef __linux__
+    cpu_set_t cpus[MAX_NODES];
+    nn = read_topology(cpus);
+    for (size_t j = 0; j < nn; j++) ncpus[j] = (size_t)CPU_COUNT(&cpus[j]);
+#endif
+    if (nn < 2) {
+        nn = 1;
+        ncpus[0] = 1;
+    }
+    size_t orig[MAX_NODES];         // index into cpus[] of each node kept
+    pool->nnodes = assign_nodes(pool, ncpus, nn, orig);
+
+    // Nothing is queued yet, so workers never look past the ones already started
+    size_t started = 0;
+    for (; started < nworkers; started++) {
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+#ifdef __linux__
+        if (pool->nnodes > 1) {
+            // Binding is a placement hint: a refused mask leaves the worker unbound
+            pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t),
+                                        &cpus[orig[pool->node_of[started]]]);
+        }
+#endif
+        int err = pthread_create(&pool->threads[started], &attr, worker_main, &pool->deques[started]);
+        if (err != 0 && pool->nnodes > 1) {
+            err = pthread_create(&pool->threads[started], NULL, worker_main, &pool->deques[started]);
+        }
+        pthread_attr_destroy(&attr);
+        if (err != 0) break;
+    }
+    if (started == 0) goto fail;
+    for (size_t i = started; i < nworkers; i++) {
+        pthread_mutex_destroy(&pool->deques[i].lock);
+        free(pool->deques[i].buf);
+    }
+    pool->nworkers = started;
+    // Workers are numbered node by node, so missing ones only shorten the last nodes
+    while (pool->node_first[pool->nnodes - 1] >= started) pool->nnodes--;
+    pool->node_first[pool->nnodes] = started;
+    return pool;
+
+fail:
+    if (pool->deques) {
+        for (size_t i = 0; i < nworkers; i++) free(pool->deques[i].buf);
+    }
+    free(pool->node_of);
+    free(pool->deques);
+    free(pool->threads);
+    free(pool);
+    return NULL;
+}
+
+void tpool_destroy(tpool_t *pool) {
+    if (!pool) return;
+    pthread_mutex_lock(&pool->sleep_lock);
+    atomic_store(&pool->stop, true);
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->sleep_lock);
+    for (size_t i = 0; i < pool->nworkers; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+    for (size_t i = 0; i < pool->nworkers; i++) {
+        pthread_mutex_destroy(&pool->deques[i].lock);
+        free(pool->deques[i].buf);
+    }
+    pthread_mutex_destroy(&pool->sleep_lock);
+    pthread_cond_destroy(&pool->wake);
+    free(pool->node_of);
+    free(pool->deques);
+    free(pool->threads);
+    free(pool);
+}
+
+size_t tpool_size(const tpool_t *pool) {
+    return pool->nworkers;
+}
+
+static tpool_t *default_pool;
+static pthread_once_t default_once = PTHREAD_ONCE_INIT;
+
+static void default_init(void) {
+    default_pool = tpool_create(0);
+}
+
+tpool_t *tpool_default(void) {
+    pthread_once(&default_once, default_init);
+    return default_pool;
+}
+
+size_t tpool_nodes(const tpool_t *pool) {
+    return pool->nnodes;
+}
+
+static void push_task(tpool_t *pool, size_t idx, task_t t) {
+    atomic_fetch_add(&t.group->pending, 1);
+    atomic_fetch_add(queue_count(pool, t.node), 1);
+    if (!deque_push(&pool->deques[idx], t)) {
+        atomic_fetch_sub(queue_count(pool, t.node), 1);
+        run_task(&t);       // deque could not grow: run it here
+        return;
+    }
+    if (atomic_load(&pool->sleepers) > 0) {
+        // A single wakeup could go to a worker that may not run a node-bound task
+        pthread_mutex_lock(&pool->sleep_lock);
+        if (t.node == ANY_NODE) {
+            pthread_cond_signal(&pool->wake);
+        } else {
+            pthread_cond_broadcast(&pool->wake);
+        }
+        pthread_mutex_unlock(&pool->sleep_lock);
+    }
+}
+
+void tpool_spawn(tpool_t *pool, tpool_group_t *group, void (*fn)(void *), void *arg) {
+    size_t idx = (tls_pool == pool) ? tls_worker
+                                    : atomic_fetch_add(&pool->next, 1) % pool->nworkers;
+    push_task(pool, idx, (task_t){fn, arg, group, ANY_NODE});
+}
+
+void tpool_spawn_on(tpool_t *pool, tpool_group_t *group, size_t node,
+                    void (*fn)(void *), void *arg) {
+    if (pool->nnodes == 1) {
+        tpool_spawn(pool, group, fn, arg);      // every thread is on the one node
+        return;
+    }
+    node %= pool->nnodes;
+    size_t lo = pool->node_first[node], n = pool->node_first[node + 1] - lo;
+    size_t idx = (tls_pool == pool && pool->node_of[tls_worker] == node)
+                     ? tls_worker : lo + atomic_fetch_add(&pool->next, 1) % n;
+    push_task(pool, idx, (task_t){fn, arg, group, node});
+}
+
+void tpool_wait(tpool_t *pool, tpool_group_t *group) {
+    while (atomic_load(&group->pending) > 0) {
+        if (!try_run_one(pool)) sched_yield();
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <stddef.h>
+#include <stdatomic.h>
+
+// Long-lived worker pool with one deque per worker and work stealing. A worker
+// pushes and pops its own tasks LIFO and steals FIFO from the others; threads
+// outside the pool hand tasks out round-robin. Idle workers spin briefly, then sleep.
+//
+// On a multi-node NUMA host (topology from /sys/devices/system/node) the workers
+// are split across the nodes in proportion to their CPUs and each is bound to
+// its node's CPUs. Workers steal from their own node first.
+typedef struct tpool tpool_t;
+
+// Tasks spawned into a group are waited for together
+typedef struct {
+    atomic_size_t pending;
+} tpool_group_t;
+
+#define TPOOL_GROUP_INIT {0}
+
+tpool_t *tpool_create(size_t nworkers);   // nworkers == 0: one per online CPU
+void tpool_destroy(tpool_t *pool);        // waits for queued tasks to finish
+size_t tpool_size(const tpool_t *pool);
+
+// Process-wide pool, created on first use and shared by every sort call
+tpool_t *tpool_default(void);
+
+// Queue fn(arg) on the pool. Safe to call from inside a task.
+void tpool_spawn(tpool_t *pool, tpool_group_t *group, void (*fn)(void *), void *arg);
+
+// NUMA nodes the workers are spread over: 1 on single-node hosts or when the
+// topology cannot be read
+size_t tpool_nodes(const tpool_t *pool);
+
+// Queue fn(arg) for the workers of node (taken modulo tpool_nodes()). No other
+// thread runs it, so pages it touches first are allocated on that node.
+void tpool_spawn_on(tpool_t *pool, tpool_group_t *group, size_t node,
+                    void (*fn)(void *), void *arg);
+
+// Return once every task of group has run; the caller executes queued tasks
+// (its own group's or others') while it waits instead of blocking.
+void tpool_wait(tpool_t *pool, tpool_group_t *group);
+
+#endif
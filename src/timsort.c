@@ -1,52 +1,75 @@
 #include "timsort.h"
+#include "stream_store.h"
+#include "sort_alloc.h"
 
-#define RUN 64   
-
-static void insertion_sort(T *arr, size_t left, size_t right) {
-    for (size_t i = left + 1; i <= right; i++) {
-        T temp = arr[i];
-        size_t j = i;
-        while (j > left && cmp(temp, arr[j-1])) {
-            arr[j] = arr[j-1];
-            j--;
-        }
-        arr[j] = temp;
-    }
-}
+#define MIN_MERGE 64    // inputs shorter than this are sorted by one insertion pass
+#define MAX_RUNS  85    // run-stack depth; the balance invariants keep it below this for any size_t n
+#define MIN_GALLOP 7    // initial streak length that switches merge() into galloping mode
+#define INPLACE_BUF 256 // fixed stack buffer (elements) used by TIMSORT_INPLACE
+#define STREAM_BLOCK 256 // merge_stream(): elements merged in cache per streaming flush
 
-static void merge(T *arr, size_t left, size_t mid, size_t right, T *temp) {
-    size_t i = left, j = mid + 1, k = left;
-    while (i <= mid && j <= right) {
-        if (cmp(arr[i], arr[j])) temp[k++] = arr[i++];
-        else temp[k++] = arr[j++];
-    }
-    while (i <= mid) temp[k++] = arr[i++];
-    while (j <= right) temp[k++] = arr[j++];
+typedef struct {
+    size_t base;
+    size_t len;
+    bool in_temp;       // run currently lives in the scratch buffer at the same offset
+} run_t;
 
-    memcpy(arr + left, temp + left, (right - left + 1) * sizeof(T));
+// minrun in [MIN_MERGE/2, MIN_MERGE] so that n/minrun is a power of two or just below one
+static size_t compute_minrun(size_t n) {
+    size_t r = 0;
+    while (n >= MIN_MERGE) {
+        r |= n & 1;
+        n >>= 1;
+    }
+    return n + r;
 }
 
-void timsort(T *arr, size_t n) {
-    if (n <= 1) return;
+// ============================================================================
+// Instantiations: one full copy of timsort_impl.h per key type, with the
+// comparator inlined into every kernel
+// ============================================================================
 
-    T *temp = malloc(sizeof(T) * n);
+#define TS_T uint32_t
+#define TS_SUFFIX u32
+#define TS_LE(a, b) ((a) <= (b))
+#include "timsort_impl.h"
 
-    // Step1: sort RUN
-    for (size_t i = 0; i < n; i += RUN) {
-        size_t right = (i + RUN - 1 < n - 1) ? i + RUN - 1 : n - 1;
-        insertion_sort(arr, i, right);
-    }
+#define TS_T uint64_t
+#define TS_SUFFIX u64
+#define TS_LE(a, b) ((a) <= (b))
+#include "timsort_impl.h"
 
-    // Step2：merge RUN
-    for (size_t size = RUN; size < n; size *= 2) {
-        for (size_t left = 0; left < n; left += 2 * size) {
-            size_t mid   = left + size - 1;
-            if (mid >= n - 1) break;
-            size_t right = (left + 2 * size - 1 < n - 1) ? left + 2 * size - 1 : n - 1;
+#define TS_T int32_t
+#define TS_SUFFIX i32
+#define TS_LE(a, b) ((a) <= (b))
+#include "timsort_impl.h"
 
-            merge(arr, left, mid, right, temp);
-        }
-    }
+#define TS_T int64_t
+#define TS_SUFFIX i64
+#define TS_LE(a, b) ((a) <= (b))
+#include "timsort_impl.h"
+
+// floating point: IEEE 754 totalOrder, the order radix_sort_f32/_f64 produce:
+// -NaN < -inf < ... < -0.0 < +0.0 < ... < +inf < +NaN. Negative keys have their
+// magnitude bits flipped, then the bits compare as signed integers.
+static inline int32_t total_order_f32(float x) {
+    int32_t b;
+    memcpy(&b, &x, sizeof(b));
+    return b ^ (int32_t)((uint32_t)(b >> 31) >> 1);
+}
 
-    free(temp);
+static inline int64_t total_order_f64(double x) {
+    int64_t b;
+    memcpy(&b, &x, sizeof(b));
+    return b ^ (int64_t)((uint64_t)(b >> 63) >> 1);
 }
+
+#define TS_T float
+#define TS_SUFFIX f32
+#define TS_LE(a, b) (total_order_f32(a) <= total_order_f32(b))
+#include "timsort_impl.h"
+
+#define TS_T double
+#define TS_SUFFIX f64
+#define TS_LE(a, b) (total_order_f64(a) <= total_order_f64(b))
+#include "timsort_impl.h"
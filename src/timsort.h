@@ -7,11 +7,74 @@
 #include <string.h>
 
 typedef uint32_t T;        // unified element type for all sorting components
+#define T_SUFFIX u32       // timsort instance used for T (must match the typedef)
 
 static inline bool cmp(T a, T b) {
     return a <= b;         // sort rule
 }
 
-void timsort(T *arr, size_t n);
+// Merge strategy for the adaptive timsort
+typedef enum {
+    TIMSORT_PINGPONG,     // n-element scratch; merges alternate between arr and scratch
+    TIMSORT_HALF_BUFFER,  // scratch <= n/2; copies only the smaller run out, merges back into arr
+    TIMSORT_INPLACE       // fixed 256-element stack buffer; rotation-based merge, still stable
+} timsort_mode_t;
+
+// Modes that fail to allocate scratch fall back to TIMSORT_INPLACE instead of failing.
+// Reusable workspace: scratch survives between calls and only grows, so repeated
+// sorts of similar sizes do no allocation. The run stack lives on the C stack.
+// timsort_with_buf() sorts with caller-owned scratch (cap elements, which must not
+// overlap arr) that it never frees or grows: TIMSORT_PINGPONG needs cap >= n, and
+// merges that do not fit fall back to rotations, as TIMSORT_INPLACE does.
+#define TS_CAT_(a, b) a##b
+#define TS_CAT(a, b) TS_CAT_(a, b)
+#define TS_NAME(name, sfx) TS_CAT(name##_, sfx)
+
+// One instance of the whole API per key type, with the comparator compiled in:
+// timsort_u32(), timsort_mode_f64(), timsort_ws_i64_t, ...
+#define TIMSORT_DECLARE(type, sfx)                                                          \
+    typedef struct {                                                                        \
+        type *temp;           /* sort_buf_alloc() memory, released by timsort_ws_free */    \
+        size_t temp_cap;      /* elements allocated in temp */                              \
+        timsort_mode_t mode;                                                                \
+        bool prefault;        /* touch every page when temp is (re)allocated */             \
+        size_t traffic_bytes; /* bytes the last sort read + wrote (runs, merges, copies) */ \
+    } TS_CAT(TS_NAME(timsort_ws, sfx), _t);                                                 \
+    void TS_NAME(timsort, sfx)(type *arr, size_t n);                     /* TIMSORT_PINGPONG */ \
+    size_t TS_NAME(timsort_mode, sfx)(type *arr, size_t n, timsort_mode_t mode); /* peak scratch bytes */ \
+    bool TS_NAME(timsort_ws_init, sfx)(TS_CAT(TS_NAME(timsort_ws, sfx), _t) *ws, size_t capacity, \
+                                       timsort_mode_t mode, bool prefault);                 \
+    void TS_NAME(timsort_with_ws, sfx)(TS_CAT(TS_NAME(timsort_ws, sfx), _t) *ws, type *arr, size_t n); \
+    void TS_NAME(timsort_ws_free, sfx)(TS_CAT(TS_NAME(timsort_ws, sfx), _t) *ws);  \
+    void TS_NAME(timsort_with_buf, sfx)(type *arr, size_t n, type *buf, size_t cap, timsort_mode_t mode);
+
+TIMSORT_DECLARE(uint32_t, u32)
+TIMSORT_DECLARE(uint64_t, u64)
+TIMSORT_DECLARE(int32_t, i32)
+TIMSORT_DECLARE(int64_t, i64)
+TIMSORT_DECLARE(float, f32)     // IEEE 754 totalOrder, as radix_sort_f32()
+TIMSORT_DECLARE(double, f64)    // IEEE 754 totalOrder, as radix_sort_f64()
+
+// Unsuffixed API: the instance for T
+typedef TS_CAT(TS_NAME(timsort_ws, T_SUFFIX), _t) timsort_ws_t;
+
+static inline void timsort(T *arr, size_t n) {
+    TS_NAME(timsort, T_SUFFIX)(arr, n);
+}
+static inline size_t timsort_mode(T *arr, size_t n, timsort_mode_t mode) {
+    return TS_NAME(timsort_mode, T_SUFFIX)(arr, n, mode);
+}
+static inline bool timsort_ws_init(timsort_ws_t *ws, size_t capacity, timsort_mode_t mode, bool prefault) {
+    return TS_NAME(timsort_ws_init, T_SUFFIX)(ws, capacity, mode, prefault);
+}
+static inline void timsort_with_ws(timsort_ws_t *ws, T *arr, size_t n) {
+    TS_NAME(timsort_with_ws, T_SUFFIX)(ws, arr, n);
+}
+static inline void timsort_ws_free(timsort_ws_t *ws) {
+    TS_NAME(timsort_ws_free, T_SUFFIX)(ws);
+}
+static inline void timsort_with_buf(T *arr, size_t n, T *buf, size_t cap, timsort_mode_t mode) {
+    TS_NAME(timsort_with_buf, T_SUFFIX)(arr, n, buf, cap, mode);
+}
 
 #endif
@@ -0,0 +1,656 @@
+// Body of the adaptive timsort, instantiated once per key type by timsort.c.
+// Before including, define TS_T (key type), TS_SUFFIX (name suffix, e.g. u32) and
+// TS_LE(a, b) ("a may stay before b"); they are undefined again at the end.
+// Inside, T and cmp() refer to the instance's key type and comparator, and every
+// function name gets the suffix (merge -> merge_u32, timsort -> timsort_u32).
+
+#define T TS_T
+#define cmp(a, b) TS_LE(a, b)
+#define TS_FN(name) TS_NAME(name, TS_SUFFIX)
+
+#define merge_state_t        TS_FN(merge_state_t)
+#define insertion_sort       TS_FN(insertion_sort)
+#define reverse              TS_FN(reverse)
+#define count_run            TS_FN(count_run)
+#define gallop_right         TS_FN(gallop_right)
+#define gallop_left          TS_FN(gallop_left)
+#define gallop_right_rev     TS_FN(gallop_right_rev)
+#define gallop_left_rev      TS_FN(gallop_left_rev)
+#define merge                TS_FN(merge)
+#define stream_flush         TS_FN(stream_flush)
+#define stream_put           TS_FN(stream_put)
+#define merge_stream         TS_FN(merge_stream)
+#define merge_hi             TS_FN(merge_hi)
+#define ensure_temp          TS_FN(ensure_temp)
+#define rotate               TS_FN(rotate)
+#define merge_half           TS_FN(merge_half)
+#define merge_at             TS_FN(merge_at)
+#define merge_collapse       TS_FN(merge_collapse)
+#define merge_force_collapse TS_FN(merge_force_collapse)
+#define sort_runs            TS_FN(sort_runs)
+#define timsort              TS_FN(timsort)
+#define timsort_mode         TS_FN(timsort_mode)
+#define timsort_ws_init      TS_FN(timsort_ws_init)
+#define timsort_with_ws      TS_FN(timsort_with_ws)
+#define timsort_ws_free      TS_FN(timsort_ws_free)
+#define timsort_with_buf     TS_FN(timsort_with_buf)
+#define timsort_ws_t         TS_CAT(TS_FN(timsort_ws), _t)
+
+typedef struct {
+    T *temp;
+    size_t temp_cap;    // elements allocated in temp
+    size_t min_gallop;  // adaptive: drops while galloping pays off, rises when it does not
+    timsort_mode_t mode;
+    bool prefault;      // touch every page of a newly grown temp up front
+    T *fixed;           // INPLACE_BUF elements on sort_runs' stack
+    bool owned;         // temp is sort_buf_alloc() memory this sort may free and regrow
+    size_t traffic;     // bytes read + written by run formation, merges and copies
+} merge_state_t;
+
+// insertion_sort in range of [left, right], where [left, start) is already sorted
+static void insertion_sort(T *arr, size_t left, size_t start, size_t right) {
+    for (size_t i = start; i <= right; i++) {
+        T temp = arr[i];
+        size_t j = i;
+        while (j > left && !cmp(arr[j-1], temp)) {   // strict: equal keys keep their order
+            arr[j] = arr[j-1];
+            j--;
+        }
+        arr[j] = temp;
+    }
+}
+
+static void reverse(T *arr, size_t left, size_t right) {
+    while (left < right) {
+        T tmp = arr[left];
+        arr[left++] = arr[right];
+        arr[right--] = tmp;
+    }
+}
+
+// length of the natural run starting at lo; strictly descending runs are reversed in place
+static size_t count_run(T *arr, size_t lo, size_t n) {
+    size_t hi = lo + 1;
+    if (hi == n) return 1;
+
+    if (!cmp(arr[lo], arr[hi])) {
+        hi++;
+        while (hi < n && !cmp(arr[hi-1], arr[hi])) hi++;
+        reverse(arr, lo, hi - 1);
+    } else {
+        hi++;
+        while (hi < n && cmp(arr[hi-1], arr[hi])) hi++;
+    }
+    return hi - lo;
+}
+
+// number of leading elements of a[0..n) that are <= key (exponential then binary search)
+static size_t gallop_right(T key, const T *a, size_t n) {
+    if (n == 0 || !cmp(a[0], key)) return 0;
+    size_t last = 0, ofs = 1;
+    while (ofs < n && cmp(a[ofs], key)) {
+        last = ofs;
+        ofs = (ofs << 1) + 1;
+    }
+    if (ofs > n) ofs = n;
+    last++;
+    while (last < ofs) {
+        size_t m = last + ((ofs - last) >> 1);
+        if (cmp(a[m], key)) last = m + 1;
+        else ofs = m;
+    }
+    return ofs;
+}
+
+// number of leading elements of a[0..n) that are < key
+static size_t gallop_left(T key, const T *a, size_t n) {
+    if (n == 0 || cmp(key, a[0])) return 0;
+    size_t last = 0, ofs = 1;
+    while (ofs < n && !cmp(key, a[ofs])) {
+        last = ofs;
+        ofs = (ofs << 1) + 1;
+    }
+    if (ofs > n) ofs = n;
+    last++;
+    while (last < ofs) {
+        size_t m = last + ((ofs - last) >> 1);
+        if (!cmp(key, a[m])) last = m + 1;
+        else ofs = m;
+    }
+    return ofs;
+}
+
+// number of trailing elements of a[0..n) that are > key (searched from the end)
+static size_t gallop_right_rev(T key, const T *a, size_t n) {
+    if (n == 0 || cmp(a[n-1], key)) return 0;
+    size_t last = 0, ofs = 1;
+    while (ofs < n && !cmp(a[n-1-ofs], key)) {
+        last = ofs;
+        ofs = (ofs << 1) + 1;
+    }
+    if (ofs > n) ofs = n;
+    last++;
+    while (last < ofs) {
+        size_t m = last + ((ofs - last) >> 1);
+        if (!cmp(a[n-1-m], key)) last = m + 1;
+        else ofs = m;
+    }
+    return ofs;
+}
+
+// number of trailing elements of a[0..n) that are >= key
+static size_t gallop_left_rev(T key, const T *a, size_t n) {
+    if (n == 0 || !cmp(key, a[n-1])) return 0;
+    size_t last = 0, ofs = 1;
+    while (ofs < n && cmp(key, a[n-1-ofs])) {
+        last = ofs;
+        ofs = (ofs << 1) + 1;
+    }
+    if (ofs > n) ofs = n;
+    last++;
+    while (last < ofs) {
+        size_t m = last + ((ofs - last) >> 1);
+        if (cmp(key, a[n-1-m])) last = m + 1;
+        else ofs = m;
+    }
+    return ofs;
+}
+
+// merge a[0..na) and b[0..nb) into dst[0..na+nb). dst never aliases a; it may be the
+// buffer that holds b (dst + na == b), which is safe because writes never overtake b's reads.
+static void merge(const T *a, size_t na, const T *b, size_t nb, T *dst, merge_state_t *ms) {
+    // a-prefix <= b[0] and b-suffix >= a[na-1] are taken without element comparisons
+    size_t i = gallop_right(b[0], a, na);
+    memcpy(dst, a, i * sizeof(T));
+    size_t nb_merge = (i < na) ? gallop_left(a[na-1], b, nb) : 0;
+
+    size_t min_gallop = ms->min_gallop;
+    size_t j = 0, k = i;
+
+    while (i < na && j < nb_merge) {
+        size_t count_a = 0, count_b = 0;
+
+        // one element at a time until one side wins min_gallop times in a row
+        do {
+            if (cmp(a[i], b[j])) {
+                dst[k++] = a[i++];
+                count_a++;
+                count_b = 0;
+            } else {
+                dst[k++] = b[j++];
+                count_b++;
+                count_a = 0;
+            }
+        } while (i < na && j < nb_merge && count_a + count_b < min_gallop);
+        if (i == na || j == nb_merge) break;
+
+        // galloping: search for the end of each streak and copy it in bulk
+        min_gallop++;
+        do {
+            if (min_gallop > 1) min_gallop--;
+
+            count_a = gallop_right(b[j], a + i, na - i);
+            memcpy(dst + k, a + i, count_a * sizeof(T));
+            k += count_a;
+            i += count_a;
+            if (i == na) break;
+            dst[k++] = b[j++];
+            if (j == nb_merge) break;
+
+            count_b = gallop_left(a[i], b + j, nb_merge - j);
+            memmove(dst + k, b + j, count_b * sizeof(T));
+            k += count_b;
+            j += count_b;
+            if (j == nb_merge) break;
+            dst[k++] = a[i++];
+            if (i == na) break;
+        } while (count_a >= MIN_GALLOP || count_b >= MIN_GALLOP);
+        min_gallop++;   // penalty for leaving galloping mode
+    }
+    ms->min_gallop = min_gallop;
+
+    memcpy(dst + k, a + i, (na - i) * sizeof(T));
+    k += na - i;
+    if (dst + k != b + j) memmove(dst + k, b + j, (nb - j) * sizeof(T));
+}
+
+// merge_stream() output: write block[0..*m) to dst + *k with streaming stores, up to the
+// last cache-line boundary it reaches (all of it when final); the rest moves to the
+// front of block. Non-final calls need *m >= STREAM_BLOCK.
+static void stream_flush(T *dst, size_t *k, T *block, size_t *m, bool final) {
+    size_t cut = final ? 0 : ((uintptr_t)(dst + *k + *m) % STREAM_LINE) / sizeof(T);
+    size_t len = *m - cut;
+    stream_copy(dst + *k, block, len * sizeof(T));
+    memmove(block, block + len, cut * sizeof(T));
+    *k += len;
+    *m = cut;
+}
+
+// append src[0..c) to the merge_stream() output; long streaks bypass the block
+static void stream_put(T *dst, size_t *k, T *block, size_t *m, const T *src, size_t c) {
+    if (c > STREAM_BLOCK) {
+        stream_flush(dst, k, block, m, true);
+        stream_copy(dst + *k, src, c * sizeof(T));
+        *k += c;
+        return;
+    }
+    memcpy(block + *m, src, c * sizeof(T));
+    *m += c;
+    if (*m >= STREAM_BLOCK) stream_flush(dst, k, block, m, false);
+}
+
+// merge() for outputs of stream_min_bytes or more: merged elements and gallops collect
+// in a small block that goes out with non-temporal stores in whole cache lines, so dst
+// lines are never read for ownership. Same galloping and aliasing rules as merge().
+static void merge_stream(const T *a, size_t na, const T *b, size_t nb, T *dst, merge_state_t *ms) {
+    size_t i = gallop_right(b[0], a, na);
+    stream_copy(dst, a, i * sizeof(T));
+    size_t nb_merge = (i < na) ? gallop_left(a[na-1], b, nb) : 0;
+
+    size_t min_gallop = ms->min_gallop;
+    size_t j = 0, k = i, m = 0;     // block[0..m) goes to dst + k
+    alignas(16) T block[2 * STREAM_BLOCK];
+
+    size_t count_a = 0, count_b = 0;
+    while (i < na && j < nb_merge) {
+        do {
+            if (cmp(a[i], b[j])) {
+                block[m++] = a[i++];
+                count_a++;
+                count_b = 0;
+            } else {
+                block[m++] = b[j++];
+                count_b++;
+                count_a = 0;
+            }
+        } while (m < STREAM_BLOCK && i < na && j < nb_merge && count_a + count_b < min_gallop);
+        if (m >= STREAM_BLOCK) stream_flush(dst, &k, block, &m, false);
+        if (i == na || j == nb_merge) break;
+        if (count_a + count_b < min_gallop) continue;   // only the block filled up
+
+        min_gallop++;
+        do {
+            if (min_gallop > 1) min_gallop--;
+
+            count_a = gallop_right(b[j], a + i, na - i);
+            stream_put(dst, &k, block, &m, a + i, count_a);
+            i += count_a;
+            if (i == na) break;
+            stream_put(dst, &k, block, &m, b + j++, 1);
+            if (j == nb_merge) break;
+
+            count_b = gallop_left(a[i], b + j, nb_merge - j);
+            stream_put(dst, &k, block, &m, b + j, count_b);
+            j += count_b;
+            if (j == nb_merge) break;
+            stream_put(dst, &k, block, &m, a + i++, 1);
+            if (i == na) break;
+        } while (count_a >= MIN_GALLOP || count_b >= MIN_GALLOP);
+        min_gallop++;
+        count_a = count_b = 0;
+    }
+    ms->min_gallop = min_gallop;
+
+    stream_put(dst, &k, block, &m, a + i, na - i);
+    stream_flush(dst, &k, block, &m, true);
+    if (dst + k != b + j) stream_copy(dst + k, b + j, (nb - j) * sizeof(T));
+    stream_fence();
+}
+
+// backward counterpart of merge() for TIMSORT_HALF_BUFFER: a[0..na) is in place and
+// b[0..nb) is a copy of the run that followed it; merge from the right end so writes
+// into a's buffer never overtake a's reads.
+static void merge_hi(T *a, size_t na, const T *b, size_t nb, merge_state_t *ms) {
+    size_t min_gallop = ms->min_gallop;
+    size_t i = na, j = nb, k = na + nb;
+
+    while (i > 0 && j > 0) {
+        size_t count_a = 0, count_b = 0;
+
+        do {
+            if (cmp(a[i-1], b[j-1])) {
+                a[--k] = b[--j];
+                count_b++;
+                count_a = 0;
+            } else {
+                a[--k] = a[--i];
+                count_a++;
+                count_b = 0;
+            }
+        } while (i > 0 && j > 0 && count_a + count_b < min_gallop);
+        if (i == 0 || j == 0) break;
+
+        min_gallop++;
+        do {
+            if (min_gallop > 1) min_gallop--;
+
+            count_a = gallop_right_rev(b[j-1], a, i);
+            k -= count_a;
+            i -= count_a;
+            memmove(a + k, a + i, count_a * sizeof(T));
+            if (i == 0) break;
+            a[--k] = b[--j];
+            if (j == 0) break;
+
+            count_b = gallop_left_rev(a[i-1], b, j);
+            k -= count_b;
+            j -= count_b;
+            memcpy(a + k, b + j, count_b * sizeof(T));
+            if (j == 0) break;
+            a[--k] = a[--i];
+            if (i == 0) break;
+        } while (count_a >= MIN_GALLOP || count_b >= MIN_GALLOP);
+        min_gallop++;   // penalty for leaving galloping mode
+    }
+    ms->min_gallop = min_gallop;
+
+    memcpy(a, b, j * sizeof(T));   // leftover a is already in place
+}
+
+// grow the scratch buffer to at least need elements; old contents are not kept.
+// If the allocation fails, the sort carries on in TIMSORT_INPLACE mode.
+static void ensure_temp(merge_state_t *ms, size_t need) {
+    if (need <= ms->temp_cap) return;
+    if (!ms->owned) {
+        // caller's buffer: never freed or regrown. Larger merges rotate through it,
+        // or through the fixed buffer when that is bigger
+        if (ms->mode == TIMSORT_PINGPONG || ms->temp_cap < INPLACE_BUF) ms->mode = TIMSORT_INPLACE;
+        return;
+    }
+    sort_buf_free(ms->temp);
+    ms->temp = sort_buf_alloc(need * sizeof(T), ms->prefault);
+    if (!ms->temp) {
+        ms->temp_cap = 0;
+        ms->mode = TIMSORT_INPLACE;
+        return;
+    }
+    ms->temp_cap = need;
+}
+
+// rotate p[0..l1+l2) so that p[l1..l1+l2) comes first; the shorter side goes
+// through buf when it fits, otherwise three reversals
+static void rotate(T *p, size_t l1, size_t l2, T *buf, size_t cap) {
+    if (l1 == 0 || l2 == 0) return;
+    if (l1 <= cap && l1 <= l2) {
+        memcpy(buf, p, l1 * sizeof(T));
+        memmove(p, p + l1, l2 * sizeof(T));
+        memcpy(p + l2, buf, l1 * sizeof(T));
+    } else if (l2 <= cap) {
+        memcpy(buf, p + l1, l2 * sizeof(T));
+        memmove(p + l2, p, l1 * sizeof(T));
+        memcpy(p, buf, l2 * sizeof(T));
+    } else {
+        reverse(p, 0, l1 - 1);
+        reverse(p, l1, l1 + l2 - 1);
+        reverse(p, 0, l1 + l2 - 1);
+    }
+}
+
+// TIMSORT_HALF_BUFFER / TIMSORT_INPLACE: both runs stay in arr (b follows a). Trim what is
+// already in place, copy only the smaller remainder out and merge back from the end that
+// keeps writes behind reads. In TIMSORT_INPLACE, when both remainders exceed the fixed
+// buffer, split at the median of the longer run, rotate the middle blocks into order and
+// merge the two halves independently (recursing on the smaller one).
+static void merge_half(T *a, size_t na, T *b, size_t nb, merge_state_t *ms) {
+    while (na > 0 && nb > 0) {
+        size_t skip = gallop_right(b[0], a, na);
+        a += skip;
+        na -= skip;
+        if (na == 0) return;
+        nb = gallop_left(a[na-1], b, nb);
+
+        size_t small = (na <= nb) ? na : nb;
+        if (ms->mode != TIMSORT_INPLACE) ensure_temp(ms, small);
+        T *temp = (ms->mode == TIMSORT_INPLACE) ? ms->fixed : ms->temp;
+        size_t cap = (ms->mode == TIMSORT_INPLACE) ? INPLACE_BUF : ms->temp_cap;
+
+        if (small <= cap) {
+            ms->traffic += 2 * (small + na + nb) * sizeof(T);
+            if (na <= nb) {
+                memcpy(temp, a, na * sizeof(T));
+                merge(temp, na, b, nb, a, ms);
+            } else {
+                memcpy(temp, b, nb * sizeof(T));
+                merge_hi(a, na, temp, nb, ms);
+            }
+            return;
+        }
+
+        size_t cut_a, cut_b;
+        if (na >= nb) {
+            cut_a = na / 2;
+            cut_b = gallop_left(a[cut_a], b, nb);
+        } else {
+            cut_b = nb / 2;
+            cut_a = gallop_right(b[cut_b], a, na);
+        }
+        rotate(a + cut_a, na - cut_a, cut_b, temp, cap);
+        ms->traffic += 2 * (na - cut_a + cut_b) * sizeof(T);
+
+        // left: a[0..cut_a) + b[0..cut_b), right: a[cut_a..na) + b[cut_b..nb)
+        T *right = a + cut_a + cut_b;
+        size_t na_r = na - cut_a, nb_r = nb - cut_b;
+        if (cut_a + cut_b <= na_r + nb_r) {
+            merge_half(a, cut_a, a + cut_a, cut_b, ms);
+            a = right;
+            na = na_r;
+            b = right + na_r;
+            nb = nb_r;
+        } else {
+            merge_half(right, na_r, right + na_r, nb_r, ms);
+            na = cut_a;
+            b = a + cut_a;
+            nb = cut_b;
+        }
+    }
+}
+
+// merge runs[i] and runs[i+1] and pop runs[i+1] off the stack. Runs live in arr or in
+// temp; the result goes to the other buffer (or to b's buffer when they differ), so
+// merged data is never copied back.
+static void merge_at(T *arr, run_t *runs, size_t *sp, size_t i, merge_state_t *ms) {
+    run_t *ra = &runs[i], *rb = &runs[i+1];
+    T *a = (ra->in_temp ? ms->temp : arr) + ra->base;
+    T *b = (rb->in_temp ? ms->temp : arr) + rb->base;
+
+    if (ms->mode != TIMSORT_PINGPONG) {
+        merge_half(a, ra->len, b, rb->len, ms);
+    } else if (cmp(a[ra->len - 1], b[0])) {
+        // already in order: at most move the shorter run next to the longer one
+        if (ra->in_temp != rb->in_temp) {
+            ms->traffic += 2 * (ra->len <= rb->len ? ra->len : rb->len) * sizeof(T);
+            if (ra->len <= rb->len) {
+                memcpy((rb->in_temp ? ms->temp : arr) + ra->base, a, ra->len * sizeof(T));
+                ra->in_temp = rb->in_temp;
+            } else {
+                memcpy((ra->in_temp ? ms->temp : arr) + rb->base, b, rb->len * sizeof(T));
+            }
+        }
+    } else {
+        bool to_temp = (ra->in_temp == rb->in_temp) ? !ra->in_temp : rb->in_temp;
+        T *dst = (to_temp ? ms->temp : arr) + ra->base;
+        ms->traffic += 2 * (ra->len + rb->len) * sizeof(T);
+        if (stream_wanted((ra->len + rb->len) * sizeof(T))) {
+            merge_stream(a, ra->len, b, rb->len, dst, ms);
+        } else {
+            merge(a, ra->len, b, rb->len, dst, ms);
+        }
+        ra->in_temp = to_temp;
+    }
+
+    ra->len += rb->len;
+    if (i + 3 == *sp) runs[i+1] = runs[i+2];
+    (*sp)--;
+}
+
+// restore the invariants len[n-2] > len[n-1] + len[n] and len[n-1] > len[n]
+static void merge_collapse(T *arr, run_t *runs, size_t *sp, merge_state_t *ms) {
+    while (*sp > 1) {
+        size_t n = *sp - 2;
+        if ((n > 0 && runs[n-1].len <= runs[n].len + runs[n+1].len) ||
+            (n > 1 && runs[n-2].len <= runs[n-1].len + runs[n].len)) {
+            if (runs[n-1].len < runs[n+1].len) n--;
+        } else if (runs[n].len > runs[n+1].len) {
+            break;
+        }
+        merge_at(arr, runs, sp, n, ms);
+    }
+}
+
+static void merge_force_collapse(T *arr, run_t *runs, size_t *sp, merge_state_t *ms) {
+    while (*sp > 1) {
+        size_t n = *sp - 2;
+        if (n > 0 && runs[n-1].len < runs[n+1].len) n--;
+        merge_at(arr, runs, sp, n, ms);
+    }
+}
+
+// sort arr[0..n) with the scratch buffer and mode held in ms (n >= MIN_MERGE)
+static void sort_runs(T *arr, size_t n, merge_state_t *ms) {
+    T fixed[INPLACE_BUF];
+    ms->fixed = fixed;
+    if (ms->mode == TIMSORT_PINGPONG) ensure_temp(ms, n);
+
+    run_t runs[MAX_RUNS];
+    size_t sp = 0;
+    size_t minrun = compute_minrun(n);
+
+    // Step1: find natural runs, extend short ones to minrun, merge while the stack is unbalanced
+    for (size_t lo = 0; lo < n; ) {
+        bool descending = lo + 1 < n && !cmp(arr[lo], arr[lo + 1]);
+        size_t len = count_run(arr, lo, n);
+        ms->traffic += (descending ? 2 : 1) * len * sizeof(T);     // scan, reversal
+        if (len < minrun) {
+            size_t force = (n - lo < minrun) ? n - lo : minrun;
+            insertion_sort(arr, lo, lo + len, lo + force - 1);
+            ms->traffic += 2 * force * sizeof(T);
+            len = force;
+        }
+        runs[sp].base = lo;
+        runs[sp].len  = len;
+        runs[sp].in_temp = false;
+        sp++;
+        merge_collapse(arr, runs, &sp, ms);
+        lo += len;
+    }
+
+    // Step2: merge what is left on the stack
+    merge_force_collapse(arr, runs, &sp, ms);
+    if (runs[0].in_temp) {
+        ms->traffic += 2 * n * sizeof(T);
+        if (stream_wanted(n * sizeof(T))) {
+            stream_copy(arr, ms->temp, n * sizeof(T));
+            stream_fence();
+        } else {
+            memcpy(arr, ms->temp, n * sizeof(T));
+        }
+    }
+}
+
+size_t timsort_mode(T *arr, size_t n, timsort_mode_t mode) {
+    if (n <= 1) return 0;
+
+    if (n < MIN_MERGE) {
+        size_t len = count_run(arr, 0, n);
+        insertion_sort(arr, 0, len, n - 1);
+        return 0;
+    }
+
+    merge_state_t ms = { NULL, 0, MIN_GALLOP, mode, false, NULL, true, 0 };
+    sort_runs(arr, n, &ms);
+    sort_buf_free(ms.temp);
+    return ms.temp_cap * sizeof(T) + (ms.mode == TIMSORT_INPLACE ? INPLACE_BUF * sizeof(T) : 0);
+}
+
+void timsort(T *arr, size_t n) {
+    timsort_mode(arr, n, TIMSORT_PINGPONG);
+}
+
+bool timsort_ws_init(timsort_ws_t *ws, size_t capacity, timsort_mode_t mode, bool prefault) {
+    ws->temp = NULL;
+    ws->temp_cap = 0;
+    ws->mode = mode;
+    ws->prefault = prefault;
+    ws->traffic_bytes = 0;
+    if (capacity == 0) return true;
+
+    if (mode == TIMSORT_INPLACE) return true;
+
+    merge_state_t ms = { NULL, 0, MIN_GALLOP, mode, prefault, NULL, true, 0 };
+    ensure_temp(&ms, mode == TIMSORT_HALF_BUFFER ? capacity / 2 + 1 : capacity);
+    if (!ms.temp) return false;
+    ws->temp = ms.temp;
+    ws->temp_cap = ms.temp_cap;
+    return true;
+}
+
+void timsort_with_ws(timsort_ws_t *ws, T *arr, size_t n) {
+    ws->traffic_bytes = 0;
+    if (n <= 1) return;
+
+    if (n < MIN_MERGE) {
+        size_t len = count_run(arr, 0, n);
+        insertion_sort(arr, 0, len, n - 1);
+        ws->traffic_bytes = 2 * n * sizeof(T);
+        return;
+    }
+
+    merge_state_t ms = { ws->temp, ws->temp_cap, MIN_GALLOP, ws->mode, ws->prefault, NULL, true, 0 };
+    sort_runs(arr, n, &ms);
+    ws->temp = ms.temp;
+    ws->temp_cap = ms.temp_cap;
+    ws->traffic_bytes = ms.traffic;
+}
+
+void timsort_ws_free(timsort_ws_t *ws) {
+    sort_buf_free(ws->temp);
+    ws->temp = NULL;
+    ws->temp_cap = 0;
+}
+
+void timsort_with_buf(T *arr, size_t n, T *buf, size_t cap, timsort_mode_t mode) {
+    if (n <= 1) return;
+
+    if (n < MIN_MERGE) {
+        size_t len = count_run(arr, 0, n);
+        insertion_sort(arr, 0, len, n - 1);
+        return;
+    }
+
+    merge_state_t ms = { buf, buf ? cap : 0, MIN_GALLOP, mode, false, NULL, false, 0 };
+    sort_runs(arr, n, &ms);
+}
+
+#undef merge_state_t
+#undef insertion_sort
+#undef reverse
+#undef count_run
+#undef gallop_right
+#undef gallop_left
+#undef gallop_right_rev
+#undef gallop_left_rev
+#undef merge
+#undef stream_flush
+#undef stream_put
+#undef merge_stream
+#undef merge_hi
+#undef ensure_temp
+#undef rotate
+#undef merge_half
+#undef merge_at
+#undef merge_collapse
+#undef merge_force_collapse
+#undef sort_runs
+#undef timsort
+#undef timsort_mode
+#undef timsort_ws_init
+#undef timsort_with_ws
+#undef timsort_ws_free
+#undef timsort_with_buf
+#undef timsort_ws_t
+#undef TS_FN
+#undef cmp
+#undef T
+#undef TS_T
+#undef TS_SUFFIX
+#undef TS_LE